@@ -0,0 +1,121 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+//Measures how TransformBatch3D scales from one thread to every hardware thread.
+//Usage: KalaGraphicsBench [transformCount] [iterations] [maxThreads]
+
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <span>
+#include <algorithm>
+
+#include "utils/kg_transform_batch3D.hpp"
+
+using KalaGraphics::Utils::Transform3D;
+using KalaGraphics::Utils::TransformBatch3D;
+using KalaGraphics::Utils::WorldMatrix3D;
+using KalaGraphics::Utils::PosTarget;
+using KalaHeaders::vec3;
+
+using std::vector;
+using std::span;
+using std::thread;
+using std::min;
+using std::milli;
+using std::chrono::steady_clock;
+using std::chrono::duration;
+using std::printf;
+using std::atoi;
+using std::memcmp;
+
+using u32 = uint32_t;
+using f32 = float;
+using f64 = double;
+
+//One root per this many transforms, the rest hang under earlier transforms of the same root
+constexpr u32 TRANSFORMS_PER_ROOT = 64;
+
+int main(int argc, char** argv)
+{
+	u32 count = argc > 1 ? static_cast<u32>(atoi(argv[1])) : 200000;
+	u32 iterations = argc > 2 ? static_cast<u32>(atoi(argv[2])) : 50;
+
+	vector<Transform3D*> transforms{};
+	vector<Transform3D*> roots{};
+	transforms.reserve(count);
+
+	for (u32 i = 0; i < count; ++i)
+	{
+		Transform3D* t = Transform3D::Initialize();
+		t->SetPos(vec3(1.0f, 0.0f, 0.0f), PosTarget::POS_LOCAL);
+
+		u32 rootStart = i - i % TRANSFORMS_PER_ROOT;
+		if (i == rootStart) roots.push_back(t);
+		else t->SetParent(transforms[rootStart + (i * 2654435761u) % (i - rootStart)]);
+
+		transforms.push_back(t);
+	}
+
+	span<const WorldMatrix3D> solved = TransformBatch3D::Solve(1);
+	vector<WorldMatrix3D> reference(solved.begin(), solved.end());
+
+	u32 maxThreads = argc > 3
+		? static_cast<u32>(atoi(argv[3]))
+		: thread::hardware_concurrency();
+	if (maxThreads == 0) maxThreads = 1;
+
+	printf("%u transforms, %u iterations, up to %u threads on %u hardware threads\n", count, iterations, maxThreads, thread::hardware_concurrency());
+
+	f64 singleMs{};
+	//1, 2, 4 and so on, the last step is always maxThreads
+	for (u32 threads = 1; threads <= maxThreads; threads = threads == maxThreads ? threads + 1 : min(threads * 2, maxThreads))
+	{
+		//warm up so the worker pool is started outside the timed solves
+		TransformBatch3D::Solve(threads);
+
+		f64 totalMs{};
+		for (u32 i = 0; i < iterations; ++i)
+		{
+			//moving every root changes every combined value, so each solve rebuilds all matrices
+			for (Transform3D* root : roots)
+			{
+				root->SetPos(vec3(static_cast<f32>(i + 1), 0.0f, 0.0f), PosTarget::POS_WORLD);
+			}
+
+			auto start = steady_clock::now();
+			TransformBatch3D::Solve(threads);
+			totalMs += duration<f64, milli>(steady_clock::now() - start).count();
+		}
+
+		//back to the reference pose, results must match the single-threaded solve bit for bit
+		for (Transform3D* root : roots) root->SetPos(vec3(0.0f), PosTarget::POS_WORLD);
+		solved = TransformBatch3D::Solve(threads);
+
+		bool isMatching = memcmp(
+			solved.data(),
+			reference.data(),
+			reference.size() * sizeof(WorldMatrix3D)) == 0;
+
+		f64 averageMs = totalMs / iterations;
+		if (threads == 1) singleMs = averageMs;
+
+		printf(
+			"%2u threads: %8.3f ms per solve, %5.2fx %s\n",
+			threads,
+			averageMs,
+			singleMs / averageMs,
+			isMatching ? "" : "MISMATCH");
+
+		if (!isMatching) return 1;
+	}
+
+	TransformBatch3D::Shutdown();
+
+	return 0;
+}
\ No newline at end of file
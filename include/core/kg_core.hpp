@@ -7,6 +7,8 @@
 
 #include <string>
 #include <functional>
+#include <atomic>
+#include <thread>
 
 #include "KalaHeaders/core_utils.hpp"
 #include "KalaHeaders/log_utils.hpp"
@@ -16,6 +18,10 @@ namespace KalaGraphics::Core
 	using std::function;
 	using std::string;
 	using std::abort;
+	using std::atomic;
+	using std::memory_order_relaxed;
+	using std::thread;
+	namespace this_thread = std::this_thread;
 	
 	using u32 = uint32_t;
 	
@@ -25,8 +31,21 @@ namespace KalaGraphics::Core
 	class LIB_API KalaGraphicsCore
 	{
 	public:
-		//The ID that is bumped by every object in KalaWindow when it needs a new ID
-		static inline u32 globalID{};
+		//The ID that is bumped by every object in KalaWindow when it needs a new ID,
+		//always go through GetNewID so IDs stay unique across loader threads
+		static inline atomic<u32> globalID{};
+
+		//The thread that loaded KalaGraphics, registries may only be mutated directly from this thread
+		static inline const thread::id mainThreadID = this_thread::get_id();
+
+		//Returns a new unique ID, safe to call from any thread
+		static inline u32 GetNewID()
+		{
+			return globalID.fetch_add(1, memory_order_relaxed) + 1;
+		}
+
+		//Returns true if the caller runs on the thread that loaded KalaGraphics
+		static inline bool IsMainThread() { return this_thread::get_id() == mainThreadID; }
 	
 		static inline function<void()> errorCallback{};
 		
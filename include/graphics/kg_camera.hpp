@@ -6,18 +6,26 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <array>
+#include <span>
 
 #include "KalaHeaders/core_utils.hpp"
 #include "KalaHeaders/math_utils.hpp"
 
 #include "utils/kg_registry.hpp"
+#include "utils/kg_pool.hpp"
 
 namespace KalaGraphics::Graphics
 {
 	using std::string;
+	using std::vector;
+	using std::array;
+	using std::span;
 
 	using KalaHeaders::vec2;
 	using KalaHeaders::vec3;
+	using KalaHeaders::vec4;
 	using KalaHeaders::mat4;
 	using KalaHeaders::quat;
 	using KalaHeaders::cross;
@@ -29,11 +37,51 @@ namespace KalaGraphics::Graphics
 	using KalaHeaders::wrap;
 	
 	using KalaGraphics::Utils::KalaGraphicsRegistry;
+	using KalaGraphics::Utils::RegistryPolicy;
+	using KalaGraphics::Utils::RegistryStorage;
+	using KalaGraphics::Utils::RegistryHierarchy;
+	using KalaGraphics::Utils::RegistryThreading;
+	using KalaGraphics::Utils::KalaGraphicsPooled;
+
+	//Axis-aligned bounding box in world space, packed so arrays of boxes can be culled in batches
+	struct LIB_API BoundingBox
+	{
+		vec3 min{};
+		vec3 max{};
+	};
+	//Bounding sphere in world space, packed so four spheres fill four SIMD registers
+	struct LIB_API BoundingSphere
+	{
+		vec3 center{};
+		f32 radius{};
+	};
+
+	//One camera in std140 layout, matrices are column-major like OpenGL expects.
+	//An array of these matches a uniform block array of the same struct
+	struct alignas(16) LIB_API CameraBlock
+	{
+		mat4 view{};
+		mat4 projection{};
+		mat4 viewProjection{};
+		mat4 inverseView{};
+		mat4 inverseProjection{};
+		mat4 inverseViewProjection{};
+
+		vec4 posNear{};   //xyz position, w near clip
+		vec4 frontFar{};  //xyz front, w far clip
+		vec4 fovAspect{}; //x fov in degrees, y aspect ratio, zw unused
+	};
 
-	class LIB_API Camera
+	class LIB_API Camera : public KalaGraphicsPooled<Camera>
 	{
 	public:
-		static inline KalaGraphicsRegistry<Camera> registry{};
+		//Cameras are few, have no hierarchy and are only touched by the main thread
+		static inline KalaGraphicsRegistry<
+			Camera,
+			RegistryPolicy<
+				RegistryStorage::STORAGE_HASH_MAP,
+				RegistryHierarchy::HIERARCHY_NONE,
+				RegistryThreading::THREADING_MAIN_ONLY>> registry{};
 
 		static Camera* Initialize(
 			const string& cameraName,
@@ -56,7 +104,10 @@ namespace KalaGraphics::Graphics
 			//skip if name is already same
 			if (newName == name) return;
 
+			string oldName = name;
 			name = newName;
+
+			registry.UpdateNameIndex(this, oldName);
 		}
 		inline const string& GetName() { return name; }
 
@@ -88,23 +139,28 @@ namespace KalaGraphics::Graphics
 			quat qz = angleaxis(radians(rotVec.z), vec3(0, 0, 1));
 
 			rotquat = normalize(qz * qy * qx);
+
+			isViewDirty = true;
 		}
 
 		inline void SetFOV(f32 newFOV)
 		{
 			fov = clamp(newFOV, 70.0f, 110.0f);
+			isProjectionDirty = true;
 		}
 		inline f32 GetFOV() const { return fov; }
 
 		inline void SetNearClip(f32 newNearClip)
 		{
 			nearClip = clamp(newNearClip, 0.001f, farClip - 0.1f);
+			isProjectionDirty = true;
 		}
 		inline f32 GetNearClip() const { return nearClip; }
 
 		inline void SetFarClip(f32 newFarClip)
 		{
 			farClip = clamp(newFarClip, nearClip + 0.1f, 1000.0f);
+			isProjectionDirty = true;
 		}
 		inline f32 GetFarClip() const { return farClip; }
 
@@ -112,6 +168,7 @@ namespace KalaGraphics::Graphics
 		inline void SetAspectRatio(f32 size)
 		{
 			aspectRatio = clamp(size, 0.001f, 10.0f);
+			isProjectionDirty = true;
 		}
 		inline f32 GetAspectRatio() const { return aspectRatio; }
 
@@ -127,14 +184,64 @@ namespace KalaGraphics::Graphics
 		}
 		inline f32 GetSensitivity() const { return sensitivity; }
 
-		mat4 GetViewMatrix() const
+		//View, projection, their inverses and the frustum are rebuilt on first access after pos, rotation,
+		//fov, aspect ratio or clip planes changed, every other access returns the cached value
+		inline const mat4& GetViewMatrix() const
+		{
+			FlushMatrices();
+			return view;
+		}
+		inline const mat4& GetProjectionMatrix() const
+		{
+			FlushMatrices();
+			return projection;
+		}
+		inline const mat4& GetViewProjectionMatrix() const
+		{
+			FlushMatrices();
+			return viewProjection;
+		}
+		inline const mat4& GetInverseViewMatrix() const
 		{
-			return lookat(pos, pos + front, up);
-		};
+			FlushMatrices();
+			return inverseView;
+		}
+		inline const mat4& GetInverseProjectionMatrix() const
+		{
+			FlushMatrices();
+			return inverseProjection;
+		}
+		inline const mat4& GetInverseViewProjectionMatrix() const
+		{
+			FlushMatrices();
+			return inverseViewProjection;
+		}
+		//Normalized left, right, bottom, top, near and far planes as xyz normal and w distance,
+		//normals point into the frustum
+		inline const array<vec4, 6>& GetFrustumPlanes() const
+		{
+			FlushMatrices();
+			return frustumPlanes;
+		}
+
+		//Tests every box against the frustum four at a time and sets bit i of outVisible
+		//if box i is at least partly inside, returns the visible count.
+		//Boxes outside the frustum but crossing two planes near a corner may be kept
+		size_t CullBoxes(
+			span<const BoundingBox> boxes,
+			vector<u64>& outVisible) const;
+		//Same as CullBoxes for bounding spheres
+		size_t CullSpheres(
+			span<const BoundingSphere> spheres,
+			vector<u64>& outVisible) const;
 
 		inline const vec3& GetUp() const { return up; }
 
-		inline void SetFront(const vec3& newFront) { front = newFront; }
+		inline void SetFront(const vec3& newFront)
+		{
+			front = newFront;
+			isViewDirty = true;
+		}
 		inline const vec3& GetFront() const { return front; }
 
 		inline void SetRight(const vec3& newRight) { right = newRight; }
@@ -148,6 +255,8 @@ namespace KalaGraphics::Graphics
 				clamp(newPos.y, -10000.0f, 10000.0f),
 				clamp(newPos.z, -10000.0f, 10000.0f)
 			};
+
+			isViewDirty = true;
 		}
 		inline const vec3& GetPos() const { return pos; }
 
@@ -165,6 +274,8 @@ namespace KalaGraphics::Graphics
 			quat qz = angleaxis(radians(clamped.z), vec3(0, 0, 1));
 
 			rotquat = qz * qy * qx;
+
+			isViewDirty = true;
 		}
 		inline const vec3& GetRotVec() const { return rotVec; }
 
@@ -184,6 +295,8 @@ namespace KalaGraphics::Graphics
 			quat qz = angleaxis(radians(clamped.z), vec3(0, 0, 1));
 
 			rotquat = qz * qy * qx;
+
+			isViewDirty = true;
 		}
 		inline const quat& Getrotquat() const { return rotquat; }
 
@@ -202,10 +315,36 @@ namespace KalaGraphics::Graphics
 			quat qz = angleaxis(radians(rotVec.z), vec3(0, 0, 1));
 
 			rotquat = qz * qy * qx;
+
+			isViewDirty = true;
 		}
 
+		//Packs every initialized camera into one contiguous std140 array, only changed cameras are rewritten.
+		//Call once per frame, returns true if the array changed since the last call and must be uploaded again
+		static bool PackCameraBlocks();
+		static inline span<const CameraBlock> GetCameraBlocks() { return cameraBlocks; }
+
+		//Position of this camera inside the packed camera blocks, valid after PackCameraBlocks
+		inline u32 GetBlockIndex() const { return blockIndex; }
+
 		~Camera();
 	private:
+		static inline vector<CameraBlock> cameraBlocks{};
+		//camera IDs in block order, a different order repacks every camera
+		static inline vector<u32> blockIDs{};
+
+		inline void FlushMatrices() const
+		{
+			if (isViewDirty
+				|| isProjectionDirty)
+			{
+				UpdateMatrices();
+			}
+		}
+		//Rebuilds whichever of view and projection is dirty with its inverse,
+		//then view-projection, its inverse and the frustum planes
+		void UpdateMatrices() const;
+
 		bool isInitialized{};
 
 		string name{};
@@ -228,5 +367,20 @@ namespace KalaGraphics::Graphics
 		vec3 pos{};
 		vec3 rotVec{};
 		quat rotquat{};
+
+		mutable bool isViewDirty = true;
+		mutable bool isProjectionDirty = true;
+
+		mutable mat4 view{};
+		mutable mat4 projection{};
+		mutable mat4 viewProjection{};
+		mutable mat4 inverseView{};
+		mutable mat4 inverseProjection{};
+		mutable mat4 inverseViewProjection{};
+		mutable array<vec4, 6> frustumPlanes{};
+
+		//matrices changed since this camera was last packed
+		mutable bool isBlockDirty = true;
+		u32 blockIndex{};
 	};
 }
\ No newline at end of file
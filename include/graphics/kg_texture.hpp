@@ -93,6 +93,9 @@ namespace KalaGraphics::Graphics
 		//Rebinds the texture
 		virtual void HotReload() = 0;
 
+		//Returns the size of this texture and its CPU-side pixel data in bytes, used by registry stats
+		virtual size_t GetMemoryUsage() const = 0;
+
 		inline const string& GetName() const { return name; }
 		inline bool SetName(const string& newName)
 		{
@@ -102,8 +105,11 @@ namespace KalaGraphics::Graphics
 				return false;
 			}
 
+			string oldName = name;
 			name = newName;
 
+			OnRenamed(oldName);
+
 			return true;
 		}
 
@@ -146,6 +152,24 @@ namespace KalaGraphics::Graphics
 		//Do not destroy manually, erase from registry instead
 		virtual ~Texture() {};
 	protected:
+		//Returns the heap data owned by the texture base in bytes
+		inline size_t GetTextureMemoryUsage() const
+		{
+			size_t total = name.capacity()
+				+ filePath.capacity()
+				+ pixels.capacity()
+				+ cubePixels.capacity() * sizeof(vector<u8>)
+				+ layerPixels.capacity() * sizeof(vector<u8>);
+
+			for (const auto& p : cubePixels) total += p.capacity();
+			for (const auto& p : layerPixels) total += p.capacity();
+
+			return total;
+		}
+
+		//Called after every successful rename so the backend registry can update its name index
+		virtual void OnRenamed(const string& oldName) {}
+
 		bool isInitialized{};
 
 		string name{};
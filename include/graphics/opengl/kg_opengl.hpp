@@ -6,6 +6,7 @@
 #pragma once
 
 #include <string>
+#include <array>
 #include <unordered_map>
 
 #include "KalaHeaders/core_utils.hpp"
@@ -15,12 +16,14 @@ namespace KalaGraphics::Graphics::OpenGL
 {
 	using std::string;
 	using std::to_string;
+	using std::array;
 	using std::unordered_map;
 	
 	using KalaHeaders::Log;
 	using KalaHeaders::LogType;
 	
 	using u32 = uint32_t;
+	using u64 = uint64_t;
 	
 	enum VSyncState
 	{
@@ -28,11 +31,55 @@ namespace KalaGraphics::Graphics::OpenGL
 		VSYNC_OFF //Framerate is uncapped, runs as fast as render loop allows, introduces tearing.
 	};
 	
+	//Shadowed value of a gl state that was never set through OpenGL_Core or was invalidated,
+	//the next call setting that state is always issued
+	inline constexpr u32 GL_STATE_UNKNOWN = UINT32_MAX;
+
+	//Texture units shadowed per context, binds to higher units are always issued
+	inline constexpr u32 MAX_SHADOWED_TEXTURE_UNITS = 16;
+	//GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY and GL_TEXTURE_CUBE_MAP, binds to other targets are always issued
+	inline constexpr u32 SHADOWED_TEXTURE_TARGET_COUNT = 3;
+
+	inline constexpr auto UNKNOWN_TEXTURE_BINDINGS = []
+	{
+		array<u32, MAX_SHADOWED_TEXTURE_UNITS * SHADOWED_TEXTURE_TARGET_COUNT> bindings{};
+		bindings.fill(GL_STATE_UNKNOWN);
+		return bindings;
+	}();
+
+	//Last state set through the state filter of OpenGL_Core in one gl context
+	struct LIB_API GLState
+	{
+		u32 isBlendEnabled = GL_STATE_UNKNOWN;
+		u32 blendSrc = GL_STATE_UNKNOWN;
+		u32 blendDst = GL_STATE_UNKNOWN;
+		u32 isDepthMaskEnabled = GL_STATE_UNKNOWN;
+		u32 isDepthTestEnabled = GL_STATE_UNKNOWN;
+
+		u32 activeTextureUnit = GL_STATE_UNKNOWN; //0 for GL_TEXTURE0
+		//texture ID per unit and target, unit * SHADOWED_TEXTURE_TARGET_COUNT + target
+		array<u32, MAX_SHADOWED_TEXTURE_UNITS * SHADOWED_TEXTURE_TARGET_COUNT> boundTextures = UNKNOWN_TEXTURE_BINDINGS;
+
+		u32 VAO = GL_STATE_UNKNOWN;
+		u32 arrayBuffer = GL_STATE_UNKNOWN;
+		u32 elementBuffer = GL_STATE_UNKNOWN; //belongs to the bound VAO, forgotten on every VAO change
+	};
+
+	//Calls that went through the state filter of one gl context since the last reset
+	struct LIB_API GLStateStats
+	{
+		u64 issuedCallCount{};
+		u64 skippedCallCount{};
+	};
+
 	//Per-window GL context
 	struct LIB_API GLContext
 	{
 		VSyncState vsyncState{};
 		u32 lastProgramID{};
+
+		GLState state{};
+		GLStateStats stateStats{};
 		
 #ifdef _WIN32
 		uintptr_t hglrc{};       //OpenGL context wia WGL
@@ -256,6 +303,90 @@ namespace KalaGraphics::Graphics::OpenGL
 			return true;
 		}
 		
+		//
+		// STATE FILTER
+		//
+
+		//Each call below reaches gl only if it changes the state last set in this gl context,
+		//the gl context must be current. Call InvalidateGLState after changing any of these states
+		//with raw gl calls, otherwise the filter may skip a call that was needed.
+
+		static void SetBlendState(
+			u32 glID,
+			bool isEnabled);
+		static void BlendFunc(
+			u32 glID,
+			u32 src,
+			u32 dst);
+		static void DepthMask(
+			u32 glID,
+			bool isEnabled);
+		static void SetDepthTestState(
+			u32 glID,
+			bool isEnabled);
+
+		//Takes GL_TEXTURE0 + unit like glActiveTexture
+		static void ActiveTexture(
+			u32 glID,
+			u32 unit);
+		//Binds to the active texture unit
+		static void BindTexture(
+			u32 glID,
+			u32 target,
+			u32 textureID);
+		static void BindVertexArray(
+			u32 glID,
+			u32 VAO);
+		//Only GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER binds are filtered
+		static void BindBuffer(
+			u32 glID,
+			u32 target,
+			u32 bufferID);
+
+		//Deletes the object and drops it from the shadowed state, deleted names are reused by gl
+		//so a stale shadowed binding would otherwise skip the bind of the next object with that name.
+		//Textures and buffers are forgotten in every gl context because they are shared between contexts
+		static void DeleteTexture(
+			u32 glID,
+			u32 textureID);
+		static void DeleteVertexArray(
+			u32 glID,
+			u32 VAO);
+		static void DeleteBuffer(
+			u32 glID,
+			u32 bufferID);
+
+		//Forgets the shadowed state of this gl context, the next call setting each state is issued
+		static void InvalidateGLState(u32 glID);
+		//Forgets the shadowed state of every gl context, for raw gl calls made
+		//without knowing which gl context is current
+		static void InvalidateAllGLStates();
+
+		static inline bool GetGLStateStats(
+			u32 glID,
+			GLStateStats& target)
+		{
+			if (!glContexts.contains(glID))
+			{
+				Log::Print(
+					"Cannot get gl state stats with gl ID '" + to_string(glID) + "' because the ID is unassigned!",
+					"OPENGL",
+					LogType::LOG_ERROR,
+					2);
+			
+				return false;
+			}
+			
+			target = glContexts[glID].stateStats;
+			
+			return true;
+		}
+		//Call at the start of a captured frame to count only the calls of that frame
+		static inline void ResetGLStateStats(u32 glID)
+		{
+			if (glContexts.contains(glID)) glContexts[glID].stateStats = {};
+		}
+		
 		//Place after any gl call to check if an issue or error has occurred within that point.
 		//Loops through all errors so that all errors at that point are printed, not just the first one.
 		static string GetError();
@@ -264,5 +395,14 @@ namespace KalaGraphics::Graphics::OpenGL
 		static inline uintptr_t hglrc{}; //master context for shared resources
 		
 		static inline unordered_map<u32, GLContext> glContexts{};
+
+		//Context of the last state filter call, widgets of one context call the filter
+		//several times in a row and map nodes never move or get erased
+		static inline u32 lastStateGLID = GL_STATE_UNKNOWN;
+		static inline GLContext* lastStateContext{};
+
+		//Shadowed state of this gl context, nullptr if it was never assigned,
+		//callers then issue the gl call without filtering it
+		static GLContext* GetStateContext(u32 glID);
 	};
 }
\ No newline at end of file
@@ -79,6 +79,9 @@ namespace KalaGraphics::Graphics::OpenGLFunctions
 	//Draws indexed primitives using array data and element indices
 	LIB_API extern PFNGLDRAWELEMENTSPROC glDrawElements;
 
+	//Draws multiple instances of indexed primitives in one call
+	LIB_API extern PFNGLDRAWELEMENTSINSTANCEDPROC glDrawElementsInstanced;
+
 	//Enables a generic vertex attribute array
 	LIB_API extern PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArray;
 
@@ -97,6 +100,9 @@ namespace KalaGraphics::Graphics::OpenGLFunctions
 	//Defines an array of generic vertex attribute data
 	LIB_API extern PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointer;
 
+	//Sets how many instances pass before a vertex attribute advances, 0 advances per vertex
+	LIB_API extern PFNGLVERTEXATTRIBDIVISORPROC glVertexAttribDivisor;
+
 	//Tells OpenGL which faces to not render before fragment shading
 	LIB_API extern PFNGLCULLFACEPROC glCullFace;
 
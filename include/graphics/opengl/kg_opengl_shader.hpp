@@ -12,6 +12,7 @@
 #include "KalaHeaders/math_utils.hpp"
 
 #include "utils/kg_registry.hpp"
+#include "utils/kg_pool.hpp"
 
 namespace KalaGraphics::Graphics::OpenGL
 {
@@ -26,6 +27,11 @@ namespace KalaGraphics::Graphics::OpenGL
 	using KalaHeaders::mat4;
 	
 	using KalaGraphics::Utils::KalaGraphicsRegistry;
+	using KalaGraphics::Utils::RegistryPolicy;
+	using KalaGraphics::Utils::RegistryStorage;
+	using KalaGraphics::Utils::RegistryHierarchy;
+	using KalaGraphics::Utils::RegistryThreading;
+	using KalaGraphics::Utils::KalaGraphicsPooled;
 
 	enum class ShaderType
 	{
@@ -52,10 +58,16 @@ namespace KalaGraphics::Graphics::OpenGL
 		u32 ID{};
 	};
 
-	class LIB_API OpenGL_Shader
+	class LIB_API OpenGL_Shader : public KalaGraphicsPooled<OpenGL_Shader>
 	{
 	public:
-		static inline KalaGraphicsRegistry<OpenGL_Shader> registry{};
+		//Shaders are looked up by ID or name only and need the gl context of the main thread
+		static inline KalaGraphicsRegistry<
+			OpenGL_Shader,
+			RegistryPolicy<
+				RegistryStorage::STORAGE_HASH_MAP,
+				RegistryHierarchy::HIERARCHY_NONE,
+				RegistryThreading::THREADING_MAIN_ONLY>> registry{};
 
 		//Create a new shader with up to three types of shader files.
 		//Geometry shaders are optional but vert and frag shader must always be filled
@@ -80,8 +92,11 @@ namespace KalaGraphics::Graphics::OpenGL
 				return false;
 			}
 
+			string oldName = name;
 			name = newName;
 
+			registry.UpdateNameIndex(this, oldName);
+
 			return true;
 		}
 
@@ -92,6 +107,18 @@ namespace KalaGraphics::Graphics::OpenGL
 		//Returns the OpenGL context ID of this shader
 		inline u32 GetGLID() const { return glID; }
 
+		//Returns the size of this shader and its kept source data in bytes, used by registry stats
+		inline size_t GetMemoryUsage() const
+		{
+			size_t total = sizeof(OpenGL_Shader) + name.capacity();
+			for (const ShaderData* d : { &vertData, &fragData, &geomData })
+			{
+				total += d->shaderPath.capacity() + d->shaderData.capacity();
+			}
+
+			return total;
+		}
+
 		//Returns true if this shader is loaded
 		inline bool IsShaderLoaded(ShaderType targetType) const
 		{
@@ -12,6 +12,7 @@
 #include "KalaHeaders/math_utils.hpp"
 
 #include "utils/kg_registry.hpp"
+#include "utils/kg_pool.hpp"
 #include "graphics/kg_texture.hpp"
 
 namespace KalaGraphics::Graphics::OpenGL
@@ -22,11 +23,22 @@ namespace KalaGraphics::Graphics::OpenGL
 	using KalaHeaders::vec2;
 	
 	using KalaGraphics::Utils::KalaGraphicsRegistry;
+	using KalaGraphics::Utils::RegistryPolicy;
+	using KalaGraphics::Utils::RegistryStorage;
+	using KalaGraphics::Utils::RegistryHierarchy;
+	using KalaGraphics::Utils::RegistryThreading;
+	using KalaGraphics::Utils::KalaGraphicsPooled;
 
-	class LIB_API OpenGL_Texture : public Texture
+	class LIB_API OpenGL_Texture : public Texture, public KalaGraphicsPooled<OpenGL_Texture>
 	{
 	public:
-		static inline KalaGraphicsRegistry<OpenGL_Texture> registry{};
+		//Textures are looked up by ID or name only and need the gl context of the main thread
+		static inline KalaGraphicsRegistry<
+			OpenGL_Texture,
+			RegistryPolicy<
+				RegistryStorage::STORAGE_HASH_MAP,
+				RegistryHierarchy::HIERARCHY_NONE,
+				RegistryThreading::THREADING_MAIN_ONLY>> registry{};
 
 		//Load a new texture from an external file.
 		//Depth is always clamped to 1 for Type_2D,
@@ -80,6 +92,8 @@ namespace KalaGraphics::Graphics::OpenGL
 
 		virtual void HotReload() override;
 
+		inline size_t GetMemoryUsage() const override { return sizeof(OpenGL_Texture) + GetTextureMemoryUsage(); }
+
 		//Returns the OpenGL texture ID of this texture
 		inline u32 GetTextureID() const { return textureID; }
 		//Returns the OpenGL context ID of this texture
@@ -87,6 +101,8 @@ namespace KalaGraphics::Graphics::OpenGL
 
 		//Do not destroy manually, erase from registry instead
 		~OpenGL_Texture() override;
+	protected:
+		void OnRenamed(const string& oldName) override { registry.UpdateNameIndex(this, oldName); }
 	private:
 		//Repeated header and footer of each texture init body with custom data in the middle
 		static OpenGL_Texture* TextureBody(
@@ -22,6 +22,7 @@ namespace KalaGraphics::Graphics::OpenGL::Shader
 
 		uniform mat4 uModel;
 		uniform mat4 uProjection;
+		uniform vec4 uUVRect = vec4(0.0, 0.0, 1.0, 1.0); //min uv, max uv of the drawn texture area
 		
 		void main()
 		{
@@ -30,7 +31,7 @@ namespace KalaGraphics::Graphics::OpenGL::Shader
 			vec4 worldPos = uProjection * uModel * vec4(aPos, 0.0, 1.0);
 			gl_Position = vec4(worldPos);
 
-			TexCoord = aTexCoord;
+			TexCoord = mix(uUVRect.xy, uUVRect.zw, aTexCoord);
 		}
 	)";
 
@@ -60,4 +61,58 @@ namespace KalaGraphics::Graphics::OpenGL::Shader
 			FragColor = vec4(texColor.rgb * safeColor, texColor.a * safeOpacity);
 		}
 	)";
+
+	//Instanced variant used by Image::RenderBatch,
+	//every per-widget uniform of the quad shader is a per-instance attribute here
+	inline constexpr string_view shader_quad_instanced_vertex = 
+	R"(
+		#version 330 core
+
+		layout (location = 0) in vec2 aPos;
+		layout (location = 1) in vec2 aTexCoord;
+
+		layout (location = 2) in mat4 aModel;  //uses locations 2 to 5
+		layout (location = 6) in vec4 aColor;  //rgb color, a opacity
+		layout (location = 7) in vec4 aUVRect; //min uv, max uv of the drawn texture area
+
+		out vec2 TexCoord;
+		out vec4 Color;
+
+		uniform mat4 uProjection;
+		
+		void main()
+		{
+			//view matrix is identity and unused
+
+			gl_Position = uProjection * aModel * vec4(aPos, 0.0, 1.0);
+
+			TexCoord = mix(aUVRect.xy, aUVRect.zw, aTexCoord);
+			Color = aColor;
+		}
+	)";
+
+	inline constexpr string_view shader_quad_instanced_fragment =
+	R"(
+		#version 330 core
+
+		in vec2 TexCoord;
+		in vec4 Color;
+		out vec4 FragColor;
+
+		uniform sampler2D uTexture;
+		uniform bool uUseTexture = false; //mark as true if you want to pass a texture
+		
+		void main()
+		{
+			float safeOpacity = clamp(Color.a, 0.0, 1.0);
+			vec3 safeColor = clamp(Color.rgb, 0.0, 1.0);
+
+			if (safeOpacity < 0.1) discard;
+
+			vec4 texColor = vec4(1.0);
+			if (uUseTexture) texColor = texture(uTexture, TexCoord);
+
+			FragColor = vec4(texColor.rgb * safeColor, texColor.a * safeOpacity);
+		}
+	)";
 }
\ No newline at end of file
@@ -13,6 +13,7 @@
 #include "KalaHeaders/import_ktf.hpp"
 
 #include "utils/kg_registry.hpp"
+#include "utils/kg_pool.hpp"
 
 namespace KalaGraphics::UI
 {
@@ -24,11 +25,22 @@ namespace KalaGraphics::UI
 	using KalaHeaders::GlyphBlock;
 	
 	using KalaGraphics::Utils::KalaGraphicsRegistry;
+	using KalaGraphics::Utils::RegistryPolicy;
+	using KalaGraphics::Utils::RegistryStorage;
+	using KalaGraphics::Utils::RegistryHierarchy;
+	using KalaGraphics::Utils::RegistryThreading;
+	using KalaGraphics::Utils::KalaGraphicsPooled;
 
-	class LIB_API Font
+	class LIB_API Font : public KalaGraphicsPooled<Font>
 	{
 	public:
-		static inline KalaGraphicsRegistry<Font> registry{};
+		//Fonts are looked up by ID or name only and may be loaded from worker threads
+		static inline KalaGraphicsRegistry<
+			Font,
+			RegistryPolicy<
+				RegistryStorage::STORAGE_HASH_MAP,
+				RegistryHierarchy::HIERARCHY_NONE,
+				RegistryThreading::THREADING_QUEUED>> registry{};
 
 		//Loads a font from disk
 		static Font* LoadFont(
@@ -45,12 +57,29 @@ namespace KalaGraphics::UI
 				&& newName.length() <= 50
 				&& newName != name)
 			{
+				string oldName = name;
 				name = newName;
+
+				registry.UpdateNameIndex(this, oldName);
 			}
 		}
 		inline const string& GetName() const { return name; }
 
 		inline const string& GetPath() const { return fontPath; }
+
+		//Returns the size of this font and its glyph data in bytes, used by registry stats
+		inline size_t GetMemoryUsage() const
+		{
+			size_t total = sizeof(Font)
+				+ name.capacity()
+				+ fontPath.capacity()
+				+ tables.capacity() * sizeof(GlyphTable)
+				+ blocks.capacity() * sizeof(GlyphBlock);
+
+			for (const auto& b : blocks) total += b.rawPixels.capacity();
+
+			return total;
+		}
 		
 		inline const GlyphHeader& GetGlyphHeader() const { return header; }
 		inline const vector<GlyphTable>& GetGlyphTables() const { return tables; }
@@ -5,16 +5,52 @@
 
 #pragma once
 
+#include <vector>
+#include <unordered_map>
+
 #include "KalaHeaders/math_utils.hpp"
 
 #include "ui/kg_widget.hpp"
 
 namespace KalaGraphics::UI
 {
+	using std::vector;
+	using std::unordered_map;
+
 	using KalaHeaders::vec2;
+	using KalaHeaders::vec4;
 	using KalaHeaders::mat3;
 
-	class LIB_API Image : public Widget
+	//Per-instance data of one batched image, matches the attribute layout of shader_quad_instanced_vertex
+	struct LIB_API ImageInstance
+	{
+		mat4 model{};
+		vec4 colorOpacity{}; //rgb color, a opacity
+		vec4 uvRect{};       //min uv, max uv
+	};
+
+	//Counters of the last Image::RenderBatch call
+	struct LIB_API ImageBatchStats
+	{
+		u32 instanceCount{};
+		u32 drawCallCount{};
+		u32 textureBindCount{};
+		u32 blendToggleCount{};
+	};
+
+	//Shared quad and streaming instance buffer of one gl context
+	struct ImageBatchGeometry
+	{
+		u32 VAO{};
+		u32 VBO{};
+		u32 EBO{};
+		u32 instanceVBO{};
+
+		//bytes allocated for the instance buffer, grown when a frame needs more
+		size_t instanceCapacity{};
+	};
+
+	class LIB_API Image : public Widget, public KalaGraphicsPooled<Image>
 	{
 	public:
 		//Initialize a new Image widget.
@@ -30,12 +66,59 @@ namespace KalaGraphics::UI
 			OpenGL_Texture* texture,
 			OpenGL_Shader* shader);
 
-		//Render this image widget. Requires handle (HDC) from your window
+		//Render this image widget. Blend, depth mask, texture and VAO state are left as set
+		//for the next widget and go through the state filter of OpenGL_Core. Requires handle (HDC) from your window
 		virtual bool Render(
 			uintptr_t handle,
 			const mat4& projection) override;
 
+		//Renders every visible image of this gl context, lowest Z first, with one instanced draw call
+		//per run of images sharing Z order, blending and texture. Model, color, opacity and UV rect
+		//of all images are streamed into one instance buffer per frame.
+		//The batch shader must use the attribute layout of shader_quad_instanced_vertex,
+		//the shaders and custom vertices of the images are not used. Requires handle (HDC) from your window
+		static bool RenderBatch(
+			u32 glID,
+			uintptr_t handle,
+			const mat4& projection,
+			OpenGL_Shader* batchShader);
+
+		static inline const ImageBatchStats& GetBatchStats() { return batchStats; }
+
+		//Texture area drawn by this image as min uv and max uv, the whole texture by default.
+		//Images sharing an atlas texture stay in one batch run whatever area they draw
+		inline void SetUVRect(const vec4& newUVRect) { uvRect = newUVRect; }
+		inline const vec4& GetUVRect() const { return uvRect; }
+
+		inline size_t GetMemoryUsage() const override { return sizeof(Image) + GetWidgetMemoryUsage(); }
+
 		//Do not destroy manually, erase from registry instead
 		virtual ~Image() override;
+	private:
+		//All initialized images in creation order, gathered by the batch renderer.
+		//Destroyed images leave nullptr until the next batch compacts them
+		static inline vector<Image*> images{};
+		static inline size_t removedImageCount{};
+
+		//Z order, blending, texture ID and gather position from high to low bits,
+		//sorted as plain integers so ties keep the creation order of the images
+		static inline vector<u64> batchKeys{};
+		static inline vector<Image*> batchImages{};
+		static inline vector<ImageInstance> batchInstances{};
+		//VAOs are not shared between gl contexts, so each context gets its own quad and instance buffer
+		static inline unordered_map<u32, ImageBatchGeometry> batchGeometry{};
+		static inline ImageBatchStats batchStats{};
+
+		vec4 uvRect = vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+		//position of this image in images
+		u32 imageIndex{};
+
+		static void CreateBatchGeometry(
+			u32 targetGLID,
+			ImageBatchGeometry& geometry);
+		//Points the instance attributes at the first instance of the next run,
+		//instanced draws cannot start at an instance offset in OpenGL 3.3
+		static void SetInstanceOffset(u32 firstInstance);
 	};
 }
\ No newline at end of file
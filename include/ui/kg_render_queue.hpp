@@ -0,0 +1,104 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include "KalaHeaders/math_utils.hpp"
+
+#include "ui/kg_widget.hpp"
+
+namespace KalaGraphics::UI
+{
+	using std::vector;
+	using std::unordered_map;
+
+	using KalaHeaders::mat4;
+
+	//Counters of the last WidgetRenderQueue::Sort call of one gl context
+	struct LIB_API RenderQueueStats
+	{
+		u32 widgetCount{};
+		//widgets whose sort key changed since the previous sort, all of them on a full sort
+		u32 changedKeyCount{};
+		//radix passes run by a full sort, passes over digits shared by every key are skipped
+		u32 radixPassCount{};
+		bool isIncremental{};
+
+		//state changes between neighbouring widgets in the sorted queue
+		u32 shaderSwitchCount{};
+		u32 textureSwitchCount{};
+		u32 blendSwitchCount{};
+	};
+
+	//Retained widgets and sort state of one gl context
+	struct RenderQueueData
+	{
+		//submitted widgets by slot, removed widgets leave nullptr until the next sort compacts them
+		vector<Widget*> widgets{};
+		//sort key of each slot at the last sort
+		vector<u64> slotKeys{};
+		vector<u64> sortedKeys{};
+		vector<Widget*> sortedWidgets{};
+
+		vector<u64> changedKeys{};
+		vector<u64> scratchKeys{};
+
+		//slots that existed at the last sort, later slots are new submissions
+		size_t sortedSlotCount{};
+		size_t removedCount{};
+		bool isFullSortNeeded = true;
+
+		RenderQueueStats stats{};
+	};
+
+	//Orders the widgets of each gl context back to front with the fewest state switches.
+	//Every widget gets a 64-bit key of Z order, blending, shader program, texture and slot from high
+	//to low bits, keys are ordered with a linear-time radix sort. Submitted widgets stay queued
+	//across frames, if only a few keys changed since the last sort the changed keys are merged
+	//into the previous order instead of sorting everything again
+	class LIB_API WidgetRenderQueue
+	{
+	public:
+		//Queues this widget in the queue of its gl context until it is removed or destroyed.
+		//Widgets with equal keys keep their submission order
+		static bool Submit(Widget* widget);
+		static void Remove(Widget* widget);
+		static void Clear(u32 glID);
+
+		//Rebuilds the keys of every queued widget of this gl context and returns the widgets
+		//lowest Z first, the view is invalidated by the next sort
+		static const vector<Widget*>& Sort(u32 glID);
+
+		//Sorts the queue of this gl context and renders every widget in that order.
+		//Requires handle (HDC) from your window
+		static bool Render(
+			u32 glID,
+			uintptr_t handle,
+			const mat4& projection);
+
+		//Z order, blending, low 16 bits of the shader program ID, low 16 bits of the texture ID
+		//and queue slot from high to low bits. IDs above 16 bits only group less tightly,
+		//Z order always decides the layering
+		static u64 MakeSortKey(
+			const Widget* widget,
+			u32 slot);
+
+		static inline bool GetStats(
+			u32 glID,
+			RenderQueueStats& target)
+		{
+			if (!queues.contains(glID)) return false;
+
+			target = queues[glID].stats;
+
+			return true;
+		}
+	private:
+		static inline unordered_map<u32, RenderQueueData> queues{};
+	};
+}
\ No newline at end of file
@@ -15,7 +15,7 @@ namespace KalaGraphics::UI
 	using KalaHeaders::kclamp;
 	using KalaHeaders::GlyphBlock;
 
-	class LIB_API Text : public Widget
+	class LIB_API Text : public Widget, public KalaGraphicsPooled<Text>
 	{
 	public:
 		//Initialize a new Text widget.
@@ -33,7 +33,8 @@ namespace KalaGraphics::UI
 			OpenGL_Texture* texture,
 			OpenGL_Shader* shader);
 			
-		//Render this text widget. Requires handle (HDC) from your window
+		//Render this text widget. Blend, depth mask, texture and VAO state are left as set
+		//for the next widget and go through the state filter of OpenGL_Core. Requires handle (HDC) from your window
 		virtual bool Render(
 			uintptr_t handle,
 			const mat4& projection) override;
@@ -75,6 +76,30 @@ namespace KalaGraphics::UI
 		void SetFontID(u32 newValue);
 		inline u32 GetFontID() const { return fontID; }
 
+		//Glyph texture of this text if no texture is assigned
+		inline u32 GetDrawTextureID() const override
+		{
+			return render.texture
+				? render.texture->GetTextureID()
+				: textureID;
+		}
+
+		//The glyph texture holds coverage in its red channel, so glyphs are always blended
+		inline bool IsAlphaBlended() const override
+		{
+			return Widget::IsAlphaBlended()
+				|| (!render.texture
+				&& textureID != 0);
+		}
+
+		inline size_t GetMemoryUsage() const override
+		{
+			return sizeof(Text)
+				+ GetWidgetMemoryUsage()
+				+ text.capacity() * sizeof(u32)
+				+ letters.capacity() * sizeof(GlyphBlock*);
+		}
+
 		//Do not destroy manually, erase from registry instead
 		virtual ~Text() override;
 	private:
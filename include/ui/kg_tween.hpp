@@ -0,0 +1,186 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include "KalaHeaders/core_utils.hpp"
+#include "KalaHeaders/math_utils.hpp"
+
+#include "ui/kg_widget.hpp"
+#include "utils/kg_transform2D.hpp"
+#include "utils/kg_registry.hpp"
+
+namespace KalaGraphics::UI
+{
+	using std::vector;
+	using std::unordered_map;
+
+	using KalaHeaders::vec2;
+	using KalaHeaders::vec3;
+
+	using KalaGraphics::Utils::Transform2D;
+	using KalaGraphics::Utils::PosTarget;
+	using KalaGraphics::Utils::RotTarget;
+	using KalaGraphics::Utils::SizeTarget;
+	using KalaGraphics::Utils::RegistryHandle;
+
+	enum class TweenEase : u8
+	{
+		EASE_LINEAR,
+		EASE_SMOOTHSTEP,    //math_utils smoothstep, slow start and end
+		EASE_IN_QUAD,       //slow start
+		EASE_OUT_QUAD,      //slow end
+		EASE_IN_OUT_QUAD,   //slow start and end
+		EASE_IN_CUBIC,      //slower start
+		EASE_OUT_CUBIC,     //slower end
+		EASE_IN_OUT_CUBIC   //slower start and end
+	};
+
+	enum class TweenTarget : u8
+	{
+		TWEEN_POS,     //Transform2D position
+		TWEEN_ROT,     //Transform2D rotation in degrees
+		TWEEN_SIZE,    //Transform2D size
+		TWEEN_COLOR,   //widget normalized color
+		TWEEN_OPACITY  //widget opacity
+	};
+
+	//Animates transforms, colors and opacity of any number of widgets in one pass per frame.
+	//Active tweens live in structure-of-arrays buffers, progress and easing of all tweens is evaluated
+	//by one branch-free loop before the results are written straight into their targets in creation order,
+	//so when several tweens animate the same value the newest one wins. Endpoints are clamped when a tween
+	//starts, tweens of one target share a group whose registry handle is checked once per update,
+	//and every moved transform is marked dirty once after all writes.
+	//Tweens of removed targets are dropped on the next update. Main thread only
+	class LIB_API TweenEngine
+	{
+	public:
+		//Each start function returns the ID of the new tween or 0 if the target is not registered.
+		//Durations of 0 or less snap to the end value on the next update
+
+		static u32 TweenPos(
+			Transform2D* target,
+			const vec2 from,
+			const vec2 to,
+			f32 duration,
+			TweenEase ease = TweenEase::EASE_LINEAR,
+			PosTarget posTarget = PosTarget::POS_WORLD);
+		//Rotations are not wrapped before interpolating, 0 to 720 spins twice
+		static u32 TweenRot(
+			Transform2D* target,
+			f32 from,
+			f32 to,
+			f32 duration,
+			TweenEase ease = TweenEase::EASE_LINEAR,
+			RotTarget rotTarget = RotTarget::ROT_WORLD);
+		static u32 TweenSize(
+			Transform2D* target,
+			const vec2 from,
+			const vec2 to,
+			f32 duration,
+			TweenEase ease = TweenEase::EASE_LINEAR,
+			SizeTarget sizeTarget = SizeTarget::SIZE_WORLD);
+
+		static u32 TweenColor(
+			Widget* target,
+			const vec3& from,
+			const vec3& to,
+			f32 duration,
+			TweenEase ease = TweenEase::EASE_LINEAR);
+		static u32 TweenOpacity(
+			Widget* target,
+			f32 from,
+			f32 to,
+			f32 duration,
+			TweenEase ease = TweenEase::EASE_LINEAR);
+
+		//Stops the tween and leaves its target at the last written value
+		static bool Stop(u32 tweenID);
+		static void StopAll();
+
+		static inline bool IsActive(u32 tweenID) { return tweenIndices.contains(tweenID); }
+		static inline size_t GetActiveCount() { return tweenIndices.size(); }
+
+		//Advances every active tween by deltaTime seconds and writes the results to their targets,
+		//finished tweens write their end value once and are removed
+		static void Update(f32 deltaTime);
+	private:
+		//One entry per tween in creation order, up to three animated components per tween.
+		//Stopped and finished tweens keep their entry with ID 0 until the next update compacts them
+		static inline vector<f32> elapsed{};
+		static inline vector<f32> invDuration{};
+
+		static inline vector<f32> fromX{};
+		static inline vector<f32> fromY{};
+		static inline vector<f32> fromZ{};
+		static inline vector<f32> deltaX{};
+		static inline vector<f32> deltaY{};
+		static inline vector<f32> deltaZ{};
+
+		static inline vector<TweenEase> eases{};
+		//eased progress of the current update
+		static inline vector<f32> progress{};
+
+		//the group handle is checked before the pointer is used so removed targets are never touched
+		static inline vector<u32> groupIndices{};
+		static inline vector<void*> targetPtrs{};
+		static inline vector<TweenTarget> targets{};
+		//PosTarget, RotTarget or SizeTarget of transform tweens
+		static inline vector<u8> subTargets{};
+		static inline vector<u32> IDs{};
+
+		//Target shared by every active tween animating it
+		struct TweenGroup
+		{
+			void* targetPtr{};
+			RegistryHandle handle{};
+			bool isTransform{};
+			//result of the handle check of the current update
+			bool isValid{};
+			//a transform of this group was written this update and still needs its dirty mark
+			bool isWritten{};
+			u32 tweenCount{};
+		};
+
+		//groups without tweens are reused through the free list
+		static inline vector<TweenGroup> groups{};
+		static inline vector<u32> freeGroups{};
+		//target to the group of its active tweens
+		static inline unordered_map<void*, u32> targetGroups{};
+		static inline vector<u32> writtenGroups{};
+
+		//tween ID to its position in the buffers
+		static inline unordered_map<u32, u32> tweenIndices{};
+		static inline u32 nextTweenID = 1;
+		static inline size_t removedCount{};
+
+		static u32 AddTween(
+			void* targetPtr,
+			RegistryHandle handle,
+			TweenTarget target,
+			u8 subTarget,
+			const vec3& from,
+			const vec3& to,
+			f32 duration,
+			TweenEase ease);
+
+		//Marks the tween at this position as removed, its entry is dropped by the next compaction
+		static void RemoveAt(u32 index);
+
+		//Returns the group of this target, a new one if the target has no tweens
+		//or the old group belongs to a destroyed target at the same address
+		static u32 AcquireGroup(
+			void* targetPtr,
+			RegistryHandle handle,
+			bool isTransform);
+		//Frees the group once its last tween is gone, its fields stay readable until it is reused
+		static void ReleaseGroup(u32 index);
+		//Drops removed entries while keeping the creation order of the rest
+		static void Compact();
+	};
+}
\ No newline at end of file
@@ -9,6 +9,8 @@
 #include <vector>
 #include <functional>
 #include <array>
+#include <span>
+#include <unordered_map>
 
 #include "KalaHeaders/core_utils.hpp"
 #include "KalaHeaders/math_utils.hpp"
@@ -18,12 +20,16 @@
 #include "graphics/opengl/kg_opengl_texture.hpp"
 #include "utils/kg_transform2d.hpp"
 #include "utils/kg_registry.hpp"
+#include "utils/kg_pool.hpp"
 
 namespace KalaGraphics::UI
 {
 	using std::string;
 	using std::vector;
 	using std::array;
+	using std::span;
+	using std::unordered_map;
+	using std::unordered_multimap;
 	using std::function;
 
 	using KalaHeaders::vec2;
@@ -46,9 +52,31 @@ namespace KalaGraphics::UI
 	using KalaGraphics::Utils::RotTarget;
 	using KalaGraphics::Utils::SizeTarget;
 	using KalaGraphics::Utils::KalaGraphicsRegistry;
+	using KalaGraphics::Utils::KalaGraphicsPooled;
 
 	constexpr u16 MAX_Z_ORDER = 1024;
 
+	//Unit quad of images and the image batch, centered on the widget position
+	inline const vector<vec2> WIDGET_QUAD_VERTICES =
+	{
+		vec2(-0.5f,  0.5f), //top-left
+		vec2(0.5f,  0.5f),  //top-right
+		vec2(0.5f, -0.5f),  //bottom-right
+		vec2(-0.5f, -0.5f)  //bottom-left
+	};
+	inline const vector<u32> WIDGET_QUAD_INDICES =
+	{
+		0, 1, 2,
+		2, 3, 0
+	};
+	inline const vector<u32> WIDGET_QUAD_UVS =
+	{
+		0, 1,
+		1, 1,
+		1, 0,
+		0, 0
+	};
+
 	enum class HitTarget
 	{
 		//uses the widgets own size and vertices to calculate hit testing
@@ -69,6 +97,36 @@ namespace KalaGraphics::UI
 		ACTION_SCROLLED  //used scrollwheel
 	};
 
+	//Oriented box of a widget quad in screen space, matches the rotation of its model matrix.
+	//Packed to two SIMD registers so arrays of boxes can be hit tested four at a time
+	struct alignas(16) LIB_API WidgetOBB
+	{
+		vec2 center{};
+		vec2 axisX = vec2(1.0f, 0.0f); //unit length, axis Y is axis X turned 90 degrees counterclockwise
+		vec2 halfSize{};
+
+		//unrotated boxes are fully answered by the AABB test
+		bool isRotated{};
+	};
+
+	//GPU buffers of one unique widget mesh, shared by every widget of the same gl context
+	//that draws the same vertices, indices and uvs
+	struct LIB_API WidgetGeometry
+	{
+		u32 VAO{};
+		u32 VBO{};
+		u32 EBO{};
+
+		u32 glID{};
+		//widgets holding this geometry, its buffers are deleted when the last one releases it
+		u32 refCount{};
+		u64 contentHash{};
+
+		vector<vec2> vertices{};
+		vector<u32> indices{};
+		vector<u32> uvs{};
+	};
+
 	struct Widget_Render
 	{
 		bool canUpdate = true;
@@ -79,24 +137,12 @@ namespace KalaGraphics::UI
 		vec3 color = vec3(1.0f);
 		f32 opacity = 1.0f;
 
-		u32 VAO{};
-		u32 VBO{};
-		u32 EBO{};
-
-		vector<vec2> vertices =
-		{
-			vec2(-0.5f,  0.5f), //top-left
-			vec2(0.5f,  0.5f),  //top-right
-			vec2(0.5f, -0.5f),  //bottom-right
-			vec2(-0.5f, -0.5f)  //bottom-left
-		};
-		vector<u32> indices =
-		{
-			0, 1, 2,
-			2, 3, 0
-		};
+		//shared mesh of this widget, 0 until the widget is initialized
+		u32 geometryID{};
 
+		//conservative bounds of the oriented box, equal to it if the widget is not rotated
 		array<vec2, 2> aabb{};
+		WidgetOBB obb{};
 
 		OpenGL_Shader* shader{};
 		OpenGL_Texture* texture{};
@@ -123,13 +169,49 @@ namespace KalaGraphics::UI
 		function<void()> function_mouse_scrolled{};
 	};
 
+	class WidgetRenderQueue;
+
 	class LIB_API Widget
 	{
 	public:
 		static inline KalaGraphicsRegistry<Widget> registry{};
+
+		//Destroys every widget while the render queue, hit grid, shared geometry and gl state
+		//they release are still alive. Runs automatically before static destruction,
+		//call it earlier to release widgets before their gl contexts are destroyed
+		static void Shutdown();
 	
-		//Returns all hit widgets at mouse position sorted by highest Z first
+		//Returns all hit widgets at mouse position sorted by highest Z first, highest ID first on equal Z.
+		//Only widgets sharing the grid cell of the point are tested against their AABB,
+		//rotated widgets inside it are then tested against their oriented box in one batch
 		static vector<Widget*> GetHitWidgets(vec2 mousePos);
+		//Returns the hit widget with the highest Z at mouse position or nullptr,
+		//same test as GetHitWidgets without allocating or sorting
+		static Widget* GetTopHitWidget(vec2 mousePos);
+
+		//Resolves the hit stack at mouse position once and caches it until the mouse moves
+		//or any widget changes its bounds, Z order or interactable state.
+		//Called by the hover getters, call it once per frame before polling many widgets
+		static void ResolveHover(vec2 mousePos);
+		//Returns the top hovered widget at mouse position or nullptr from the hover cache
+		static inline Widget* GetHoveredWidget(vec2 mousePos)
+		{
+			ResolveHover(mousePos);
+			return hoveredWidget;
+		}
+		//Returns all hovered widgets at mouse position sorted by highest Z first from the hover cache,
+		//invalidated by the next resolve at another position or after any widget change
+		static inline const vector<Widget*>& GetHoverStack(vec2 mousePos)
+		{
+			ResolveHover(mousePos);
+			return hoverStack;
+		}
+
+		//Tests the point against every box four at a time and sets bit i of outHits if box i contains it
+		static void TestPointInOBBs(
+			vec2 point,
+			span<const WidgetOBB> boxes,
+			vector<u64>& outHits);
 
 		//
 		// CORE
@@ -142,6 +224,9 @@ namespace KalaGraphics::UI
 			uintptr_t handle,
 			const mat4& projection) = 0;
 
+		//Returns the size of this widget and the heap data it owns in bytes, used by registry stats
+		virtual size_t GetMemoryUsage() const = 0;
+
 		//Adjusts widget position relative to viewport size and offset,
 		//offset at {1.0f, 1.0f} means the widget is centered, {0.0f, 0.0f} moves it to the bottom left corner
 		inline void MoveWidget(
@@ -186,7 +271,10 @@ namespace KalaGraphics::UI
 				&& newName.length() <= 50
 				&& newName != name)
 			{
+				string oldName = name;
 				name = newName;
+
+				registry.UpdateNameIndex(this, oldName);
 			}
 		}
 		inline const string& GetName() const { return name; }
@@ -197,14 +285,29 @@ namespace KalaGraphics::UI
 		{
 			transform->SetPos(vec2(0.0f), PosTarget::POS_LOCAL);
 			transform->SetRot(0.0f, RotTarget::ROT_LOCAL);
-			transform->SetSize(0.0f, SizeTarget::SIZE_LOCAL);
+			transform->SetSize(vec2(1.0f), SizeTarget::SIZE_LOCAL);
 		}
 		
-		inline void SetVertices(const vector<vec2>& newVertices) { render.vertices = newVertices; }
-		inline void SetIndices(const vector<u32>& newIndices) { render.indices = newIndices; }
+		//Replaces the mesh of this widget, the new mesh is shared with every widget already drawing it
+		inline void SetVertices(const vector<vec2>& newVertices)
+		{
+			const WidgetGeometry& geometry = GetGeometry(render.geometryID);
+			SetGeometry(newVertices, geometry.indices, geometry.uvs);
+		}
+		//Replaces the mesh of this widget, the new mesh is shared with every widget already drawing it
+		inline void SetIndices(const vector<u32>& newIndices)
+		{
+			const WidgetGeometry& geometry = GetGeometry(render.geometryID);
+			SetGeometry(geometry.vertices, newIndices, geometry.uvs);
+		}
+
+		//Valid until the next widget mesh is created or released
+		inline const vector<vec2>& GetVertices() const { return GetGeometry(render.geometryID).vertices; };
+		//Valid until the next widget mesh is created or released
+		inline const vector<u32>& GetIndices() const { return GetGeometry(render.geometryID).indices; }
 
-		inline const vector<vec2>& GetVertices() const { return render.vertices; };
-		inline const vector<u32>& GetIndices() const { return render.indices; }
+		//Returns how many unique meshes are alive across all widgets
+		static inline size_t GetGeometryCount() { return geometries.size() - freeGeometryIDs.size(); }
 
 		inline Transform2D* GetTransform() { return transform; }
 		inline const array<vec2, 2>& GetAABB()
@@ -212,6 +315,11 @@ namespace KalaGraphics::UI
 			UpdateAABB();
 			return render.aabb; 
 		}
+		inline const WidgetOBB& GetOBB()
+		{
+			UpdateAABB();
+			return render.obb;
+		}
 
 		//
 		// Z ORDER
@@ -231,7 +339,7 @@ namespace KalaGraphics::UI
 
 			u16 newZOrder = clamp(++targetZOrder, static_cast<u16>(0), MAX_Z_ORDER);
 
-			zOrder = newZOrder;
+			SetZOrder(newZOrder);
 		}
 		//Makes this widget Z order 1 unit lower than target widget
 		inline void MoveBelow(Widget* targetWidget)
@@ -250,14 +358,16 @@ namespace KalaGraphics::UI
 
 			u16 newZOrder = clamp(--targetZOrder, static_cast<u16>(0), MAX_Z_ORDER);
 
-			zOrder = newZOrder;
+			SetZOrder(newZOrder);
 		}
 
 		inline void SetZOrder(u16 newZOrder)
 		{
 			u16 clamped = clamp(newZOrder, static_cast<u16>(0), MAX_Z_ORDER);
+			if (clamped == zOrder) return;
 
 			zOrder = clamped;
+			++hitRevision;
 		}
 		inline u16 GetZOrder() const { return zOrder; }
 
@@ -266,12 +376,19 @@ namespace KalaGraphics::UI
 		//
 
 		//Skip hit testing and event polling if true
-		inline void SetInteractableState(bool newValue) { isInteractable = newValue; }
+		inline void SetInteractableState(bool newValue)
+		{
+			if (newValue == isInteractable) return;
+
+			isInteractable = newValue;
+			++hitRevision;
+		}
 		//Skip hit testing and event polling if true
 		inline bool IsInteractable() const { return isInteractable; }
 
 		//If the cursor is over this widget and this widget is not
-		//covered entirely or partially by another widget then this returns true
+		//covered entirely or partially by another widget then this returns true.
+		//Answered from the hover cache, only the first widget asking at a new position resolves it
 		bool IsHovered(vec2 mousePos) const;
 
 		//Accepts mouse buttons for pressed, released, held and dragged events.
@@ -489,9 +606,12 @@ namespace KalaGraphics::UI
 		}
 		inline f32 GetOpacity() const { return render.opacity; }
 
-		inline u32 GetVAO() const { return render.VAO; }
-		inline u32 GetVBO() const { return render.VBO; }
-		inline u32 GetEBO() const { return render.EBO; }
+		//Shared with every widget drawing the same mesh, do not delete
+		inline u32 GetVAO() const { return GetGeometry(render.geometryID).VAO; }
+		//Shared with every widget drawing the same mesh, do not delete
+		inline u32 GetVBO() const { return GetGeometry(render.geometryID).VBO; }
+		//Shared with every widget drawing the same mesh, do not delete
+		inline u32 GetEBO() const { return GetGeometry(render.geometryID).EBO; }
 
 		inline const OpenGL_Shader* GetShader() const { return render.shader; }
 
@@ -506,24 +626,98 @@ namespace KalaGraphics::UI
 		inline void ClearTexture() { render.texture = nullptr; }
 		inline const OpenGL_Texture* GetTexture() const { return render.texture; }
 
+		//Returns the texture ID bound when this widget is drawn, 0 if it draws untextured
+		virtual u32 GetDrawTextureID() const
+		{
+			return render.texture
+				? render.texture->GetTextureID()
+				: 0;
+		}
+
+		//Translucent widgets and textures with an alpha channel are drawn with blending and without depth writes
+		virtual bool IsAlphaBlended() const;
+
 		//Do not destroy manually, erase from registry instead
 		virtual ~Widget() = 0;
 	protected:
+		friend class WidgetRenderQueue;
+		friend class TweenEngine;
+
+		//Returns the heap data owned by the widget base in bytes
+		inline size_t GetWidgetMemoryUsage() const
+		{
+			//meshes are shared and not owned by any single widget
+			return name.capacity();
+		}
+
+		//Widgets are bucketed into square screen cells by their AABB so point queries
+		//only test the widgets of one cell, widgets covering too many cells are tested by every query
+		static inline unordered_map<u64, vector<Widget*>> hitGrid{};
+		static inline vector<Widget*> oversizedHitWidgets{};
+
+		//Bumped whenever any widget changes its bounds, Z order or interactable state or is removed
+		static inline u64 hitRevision{};
+
+		//Last resolved hover state, valid while the mouse position and hit revision match
+		static inline vector<Widget*> hoverStack{};
+		static inline Widget* hoveredWidget{};
+		static inline vec2 hoverMousePos{};
+		static inline u64 hoverRevision{};
+		static inline bool isHoverResolved{};
+
+		//Moves this widget to the cells covered by its current AABB, does nothing if the cells did not change
+		void UpdateHitGrid();
+		void RemoveFromHitGrid();
+
+		//Rebuilds the oriented box from combined pos, rot and size, then its conservative AABB
 		inline void UpdateAABB()
 		{
 			vec2 pos = transform->GetPos(PosTarget::POS_COMBINED);
+			f32 rot = transform->GetRot(RotTarget::ROT_COMBINED);
 			vec2 size = transform->GetSize(SizeTarget::SIZE_COMBINED);
 
-			//f32 tempHeight = 1080.0f;
+			vec2 half = size * 0.5f;
 
-			//vec2 offset = vec2(0.0f, -(size.y * 0.7f * tempHeight));
+			WidgetOBB& obb = render.obb;
+			WidgetOBB oldOBB = obb;
 
-			vec2 half = size * 0.5f;
+			obb.center = pos;
+			obb.halfSize = half;
+			obb.isRotated = wrap(rot) != 0.0f;
+
+			vec2 extent = half;
+
+			if (!obb.isRotated) obb.axisX = vec2(1.0f, 0.0f);
+			else
+			{
+				//same rotation direction as createumodel
+				f32 rads = radians(rot);
+				f32 c = cos(rads);
+				f32 s = sin(rads);
+
+				obb.axisX = vec2(c, -s);
+
+				extent = vec2(
+					abs(c) * half.x + abs(s) * half.y,
+					abs(s) * half.x + abs(c) * half.y);
+			}
+
+			render.aabb[0] = pos - extent; //min
+			render.aabb[1] = pos + extent; //max
 
-			render.aabb[0] = pos - half; //+ offset; //min
-			render.aabb[1] = pos + half; //+ offset; //max
+			if (obb.center != oldOBB.center
+				|| obb.halfSize != oldOBB.halfSize
+				|| obb.axisX != oldOBB.axisX)
+			{
+				++hitRevision;
+			}
+
+			UpdateHitGrid();
 		}
 
+		//Rebuilds the AABB if pos, rot or size of the widget changed since the last render
+		void UpdateAABBIfMoved();
+
 		bool isInitialized{};
 
 		string name = "NO_NAME_ADDED";
@@ -540,6 +734,15 @@ namespace KalaGraphics::UI
 
 		bool isInteractable = true;
 
+		//min x, min y, max x, max y of the hit grid cells this widget is listed in
+		array<i32, 4> hitGridCells{};
+		bool isInHitGrid{};
+		bool isOversizedHit{};
+
+		//position of this widget in the render queue of its gl context, low bits of its sort key
+		u32 renderQueueSlot{};
+		bool isInRenderQueue{};
+
 		vec2 lastPos{};
 		f32 lastRot{};
 		vec2 lastSize{};
@@ -548,7 +751,34 @@ namespace KalaGraphics::UI
 		Widget_Render render{};
 		Widget_Event event{};
 
+		//Unique meshes by ID - 1, released slots are reused through the free list
+		static inline vector<WidgetGeometry> geometries{};
+		static inline vector<u32> freeGeometryIDs{};
+		//content hash to geometry ID, several IDs share a hash only on collisions
+		static inline unordered_multimap<u64, u32> geometryLookup{};
+
+		//Returns the ID of the mesh with this content in this gl context,
+		//creating its buffers only if no widget uses this mesh yet
+		static u32 AcquireGeometry(
+			u32 targetGLID,
+			const vector<vec2>& vertices,
+			const vector<u32>& indices,
+			const vector<u32>& uvs);
+		//Deletes the buffers of this mesh once no widget holds it anymore
+		static void ReleaseGeometry(u32 geometryID);
+		//Returns an empty geometry for ID 0 or released IDs
+		static const WidgetGeometry& GetGeometry(u32 geometryID);
+
+		//Moves this widget to the mesh with this content, parameters are copies
+		//because the old mesh may be released while the new one is acquired
+		void SetGeometry(
+			vector<vec2> vertices,
+			vector<u32> indices,
+			vector<u32> uvs);
+
+		//Creates one VAO, VBO and EBO set, called once per unique mesh
 		static void CreateWidgetGeometry(
+			u32 targetGLID,
 			const vector<vec2>& vertices,
 			const vector<u32>& indices,
 			const vector<u32>& uvs,
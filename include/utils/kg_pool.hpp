@@ -0,0 +1,140 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <new>
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+
+#include "KalaHeaders/core_utils.hpp"
+#include "KalaHeaders/thread_utils.hpp"
+
+namespace KalaGraphics::Utils
+{
+	using std::atomic;
+	using std::max;
+	using std::byte;
+	using std::size_t;
+
+	using KalaHeaders::lockwait;
+	using KalaHeaders::unlock;
+
+	using u32 = uint32_t;
+
+	//Fixed-size block pool for all instances of class T, blocks are carved out of
+	//chunks of BlocksPerChunk neighbouring blocks and recycled through an intrusive free list.
+	//Creating and destroying T is allocation-free once enough blocks exist, call Reserve to warm it up.
+	//Chunks are never returned to the heap, so content destroyed during static destruction can still free its block.
+	//Classes opt in by inheriting KalaGraphicsPooled
+	template<typename T, u32 BlocksPerChunk = 64>
+	struct LIB_API KalaGraphicsPool
+	{
+		//Free blocks store the link to the next free block in place of T
+		struct FreeBlock
+		{
+			FreeBlock* next{};
+		};
+
+		static constexpr size_t blockAlign = max(alignof(T), alignof(FreeBlock));
+		static constexpr size_t blockSize = (max(sizeof(T), sizeof(FreeBlock)) + blockAlign - 1) / blockAlign * blockAlign;
+
+		struct alignas(blockAlign) Chunk
+		{
+			byte blocks[blockSize * BlocksPerChunk];
+		};
+
+		//Returns a block for a new T, sizes other than sizeof(T) come from
+		//classes derived from T and fall back to the global heap
+		static inline void* Allocate(size_t size)
+		{
+			if (size != sizeof(T)) return ::operator new(size);
+
+			lockwait(poolLock);
+
+			if (!firstFree) AddChunk();
+
+			FreeBlock* block = firstFree;
+			firstFree = block->next;
+			++liveCount;
+
+			unlock(poolLock);
+
+			return block;
+		}
+
+		//Returns the block of a destroyed T to the free list
+		static inline void Free(
+			void* ptr,
+			size_t size)
+		{
+			if (!ptr) return;
+
+			if (size != sizeof(T))
+			{
+				::operator delete(ptr);
+				return;
+			}
+
+			lockwait(poolLock);
+
+			FreeBlock* block = new (ptr) FreeBlock{ firstFree };
+			firstFree = block;
+			--liveCount;
+
+			unlock(poolLock);
+		}
+
+		//Makes sure at least this many T can be created without new chunks
+		static inline void Reserve(u32 count)
+		{
+			lockwait(poolLock);
+
+			while (chunkCount * BlocksPerChunk < count) AddChunk();
+
+			unlock(poolLock);
+		}
+
+		//Returns the amount of T currently living in this pool
+		static inline u32 GetLiveCount() { return liveCount; }
+		//Returns the amount of blocks this pool has carved out so far
+		static inline u32 GetCapacity() { return chunkCount * BlocksPerChunk; }
+	private:
+		static inline FreeBlock* firstFree{};
+		static inline u32 chunkCount{};
+		static inline u32 liveCount{};
+		static inline atomic<bool> poolLock{};
+
+		//Carves a new chunk into free blocks, the lowest address ends up at the head
+		//so consecutive creations land in consecutive blocks
+		static inline void AddChunk()
+		{
+			Chunk* chunk = new Chunk();
+
+			for (u32 i = BlocksPerChunk; i > 0; --i)
+			{
+				firstFree = new (chunk->blocks + (i - 1) * blockSize) FreeBlock{ firstFree };
+			}
+
+			++chunkCount;
+		}
+	};
+
+	//Routes new and delete of T through KalaGraphicsPool<T>, inherit it as class T : public KalaGraphicsPooled<T>.
+	//Every pooled class gets its own pool, so instances walked together by per-frame passes
+	//sit next to each other instead of being scattered across the heap
+	template<typename T>
+	struct LIB_API KalaGraphicsPooled
+	{
+		static inline void* operator new(size_t size) { return KalaGraphicsPool<T>::Allocate(size); }
+		static inline void operator delete(
+			void* ptr,
+			size_t size)
+		{
+			KalaGraphicsPool<T>::Free(ptr, size);
+		}
+	};
+}
\ No newline at end of file
@@ -10,8 +10,20 @@
 #include <unordered_map>
 #include <vector>
 #include <memory>
+#include <utility>
 #include <algorithm>
 #include <type_traits>
+#include <span>
+#include <limits>
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <concepts>
+#include <array>
+#include <chrono>
+#include <typeinfo>
+#include <bit>
 
 namespace KalaGraphics::Utils
 {
@@ -19,27 +31,235 @@ namespace KalaGraphics::Utils
 	using std::vector;
 	using std::unique_ptr;
 	using std::make_unique;
+	using std::move;
 	using std::find;
 	using std::remove;
 	using std::remove_if;
 	using std::is_class_v;
+	using std::conditional_t;
+	using std::span;
+	using std::numeric_limits;
+	using std::atomic;
+	using std::memory_order_acquire;
+	using std::memory_order_release;
+	using std::memory_order_relaxed;
+	using std::string;
+	using std::string_view;
+	using std::hash;
+	using std::equal_to;
+	using std::convertible_to;
+	using std::array;
+	using std::to_string;
+	using std::bit_width;
+	using std::chrono::steady_clock;
+	using std::chrono::nanoseconds;
+	using std::chrono::duration_cast;
+	
+	using u64 = uint64_t;
 	
 	using u32 = uint32_t;
+
+	//Marks an unused slot, dense position or free list end
+	constexpr u32 REGISTRY_INVALID_INDEX = numeric_limits<u32>::max();
+
+	//Generational handle to content inside a KalaGraphicsRegistry,
+	//goes stale as soon as the content it points to is removed
+	struct LIB_API RegistryHandle
+	{
+		u32 index = REGISTRY_INVALID_INDEX;
+		u32 generation{};
+
+		inline bool IsValid() const { return index != REGISTRY_INVALID_INDEX; }
+
+		inline bool operator==(const RegistryHandle& other) const = default;
+	};
+
+	//How a KalaGraphicsRegistry maps IDs to its densely packed content
+	enum class RegistryStorage
+	{
+		STORAGE_SLOT_MAP,   //generational slots with a free list, stable handles, grows as needed
+		STORAGE_HASH_MAP,   //IDs map straight to dense positions, no free list or handles, least overhead per content
+		STORAGE_FIXED_ARRAY //generational slots with a compile-time capacity, containers never reallocate
+	};
+
+	//How a KalaGraphicsRegistry links parents and children
+	enum class RegistryHierarchy
+	{
+		HIERARCHY_NONE,     //no hierarchy nodes and no traversal order
+		HIERARCHY_VECTOR,   //parent pointer and children vector per content, works with every storage
+		HIERARCHY_INTRUSIVE //slot-indexed parent, child and sibling links, needs the stable slots of slot map or fixed array storage
+	};
+
+	//Which threads may add content to a KalaGraphicsRegistry
+	enum class RegistryThreading
+	{
+		THREADING_MAIN_ONLY, //only the main thread touches the registry
+		THREADING_QUEUED     //other threads queue content lock-free and the main thread flushes it
+	};
+
+	//Compile-time configuration of a KalaGraphicsRegistry.
+	//FixedCapacity is only used by STORAGE_FIXED_ARRAY
+	template<
+		RegistryStorage Storage = RegistryStorage::STORAGE_SLOT_MAP,
+		RegistryHierarchy Hierarchy = RegistryHierarchy::HIERARCHY_INTRUSIVE,
+		RegistryThreading Threading = RegistryThreading::THREADING_MAIN_ONLY,
+		u32 FixedCapacity = 0>
+	struct LIB_API RegistryPolicy
+	{
+		static constexpr RegistryStorage storage = Storage;
+		static constexpr RegistryHierarchy hierarchy = Hierarchy;
+		static constexpr RegistryThreading threading = Threading;
+		static constexpr u32 fixedCapacity = FixedCapacity;
+
+		static_assert(
+			Storage != RegistryStorage::STORAGE_FIXED_ARRAY
+			|| FixedCapacity > 0,
+			"Fixed array storage needs a capacity above 0!");
+		static_assert(
+			Storage != RegistryStorage::STORAGE_HASH_MAP
+			|| Hierarchy != RegistryHierarchy::HIERARCHY_INTRUSIVE,
+			"Intrusive hierarchy links need the stable slots of slot map or fixed array storage!");
+	};
+
+	//Sparse slot of the registry slot map, points to the dense position of its content.
+	//Hash map storage keeps one slot per dense position instead, moved along with its content
+	struct LIB_API RegistrySlot
+	{
+		u32 denseIndex = REGISTRY_INVALID_INDEX;
+		u32 generation = 1;                   //bumped every time this slot is freed
+		u32 nextFree = REGISTRY_INVALID_INDEX; //next slot in the free list
+		u32 ID{};                             //global ID of the content in this slot
+		bool isPendingRemoval{};              //content stays alive until FlushRemovedContent
+		u32 windowPosition = REGISTRY_INVALID_INDEX; //position inside its window index bucket
+		u32 namePosition = REGISTRY_INVALID_INDEX;   //position inside its name index bucket
+	};
+
+	//Transparent string hash so name lookups accept string views without building a string
+	struct LIB_API RegistryNameHash
+	{
+		using is_transparent = void;
+
+		inline size_t operator()(string_view value) const { return hash<string_view>{}(value); }
+	};
+
+	//Amount of log2 nanosecond latency buckets kept per registry operation,
+	//bucket i counts operations that took less than 2^i nanoseconds
+	constexpr u32 REGISTRY_LATENCY_BUCKETS = 32;
+
+	enum class RegistryStatTarget
+	{
+		STAT_INSERT,
+		STAT_REMOVE,
+		STAT_LOOKUP
+	};
+
+	//Opt-in counters of a single KalaGraphicsRegistry, see KalaGraphicsRegistry::SetStatsState
+	struct LIB_API RegistryStats
+	{
+		u32 liveCount{};
+		u32 peakCount{};
+
+		size_t contentBytes{};   //sizeof each content plus its heap data if it has 'size_t GetMemoryUsage()'
+		size_t containerBytes{}; //capacity held by the registry containers and indexes
+
+		u64 insertCount{};
+		u64 removeCount{};
+		u64 lookupCount{};
+		u64 lookupMissCount{};
+
+		array<u64, REGISTRY_LATENCY_BUCKETS> insertLatency{};
+		//one sample per removal, a bulk compaction of FlushRemovedContent is one sample for the whole flush
+		array<u64, REGISTRY_LATENCY_BUCKETS> removeLatency{};
+		array<u64, REGISTRY_LATENCY_BUCKETS> lookupLatency{};
+	};
+
+	//Content that can report its own heap usage for registry stats
+	template<typename T>
+	concept HasRegistryMemoryUsage = requires(const T& t) { { t.GetMemoryUsage() } -> convertible_to<size_t>; };
+
+	//Content that reports the window it belongs to, indexed by window ID
+	template<typename T>
+	concept HasRegistryWindowID = requires(T& t) { { t.GetWindowID() } -> convertible_to<u32>; };
+
+	//Content that has a name, indexed by name
+	template<typename T>
+	concept HasRegistryName = requires(T& t) { { t.GetName() } -> convertible_to<string_view>; };
+
+	//Content that caches values relative to its parent, notified by the hierarchy
+	//every time its parent changes, including when the parent itself is removed
+	template<typename T>
+	concept HasRegistryParentHook = requires(T& t) { t.OnParentChanged(); };
+
+	//One entry of the flattened pre-order traversal of a KalaGraphicsRegistry.
+	//Every parent comes before its children and each subtree is a contiguous range
+	//starting at the entry of its root, so full-tree passes are a single linear sweep
+	template<typename T>
+		requires is_class_v<T>
+	struct LIB_API KalaGraphicsTraversalEntry
+	{
+		T* object{};
+		u32 slot = REGISTRY_INVALID_INDEX;        //registry slot index of this object
+		u32 parentIndex = REGISTRY_INVALID_INDEX; //traversal index of the parent, invalid for roots
+		u32 subtreeSize = 1;                      //amount of entries in this subtree, including this object
+	};
 	
-	//Stores local non-owning pointers per T instance inside the Registry struct
+	//Stores intrusive parent, first child and sibling links per T instance inside the Registry struct.
+	//Links are registry slot indices so attaching and detaching only touch the direct neighbours
 	template<typename T>
 		requires is_class_v<T>
 	struct LIB_API KalaGraphicsHierarchy
 	{
 		T* thisObject{};
-		T* parent{};
-		vector<T*> children{};
+
+		u32 self = REGISTRY_INVALID_INDEX;        //slot index of this object
+		u32 parent = REGISTRY_INVALID_INDEX;      //slot index of the parent
+		u32 firstChild = REGISTRY_INVALID_INDEX;  //slot index of the first child
+		u32 lastChild = REGISTRY_INVALID_INDEX;   //slot index of the last child, keeps appends O(1)
+		u32 prevSibling = REGISTRY_INVALID_INDEX; //slot index of the previous child of the parent
+		u32 nextSibling = REGISTRY_INVALID_INDEX; //slot index of the next child of the parent
+		u32 childCount{};
+
+		u32 traversalIndex = REGISTRY_INVALID_INDEX; //position in the cached traversal order, valid only while it is not dirty
 		
 		//Returns the top-most parent of this target
-		inline T* GetRoot() { return parent ? T::registry.hierarchy[parent].GetRoot() : this; }
+		inline T* GetRoot() 
+		{ 
+			if (!thisObject) return nullptr;
+
+			u32 current = self;
+			while (T::registry.hierarchy[current].parent != REGISTRY_INVALID_INDEX)
+			{
+				current = T::registry.hierarchy[current].parent;
+			}
+
+			return T::registry.hierarchy[current].thisObject;
+		}
+
+		//Returns true if the ancestor slot is found by walking up the parent chain of the target slot.
+		//Costs O(depth) and never recurses, so deep hierarchies can't overflow the stack
+		static inline bool IsAncestor(
+			u32 ancestorSlot,
+			u32 targetSlot)
+		{
+			if (ancestorSlot == REGISTRY_INVALID_INDEX
+				|| targetSlot == REGISTRY_INVALID_INDEX)
+			{
+				return false;
+			}
+
+			u32 current = T::registry.hierarchy[targetSlot].parent;
+			while (current != REGISTRY_INVALID_INDEX)
+			{
+				if (current == ancestorSlot) return true;
+
+				current = T::registry.hierarchy[current].parent;
+			}
+
+			return false;
+		}
 
 		//Returns true if target target is connected
-		//to current target as a child, parent or sibling.
+		//to current target as a child or parent.
 		//Set recursive to true if you want deep target search
 		inline bool HasTarget(
 			T* targetObject,
@@ -53,78 +273,54 @@ namespace KalaGraphics::Utils
 
 			if (thisObject == targetObject) return true;
 
-			//check descendants
-			for (auto* c : children)
-			{
-				if (c == targetObject) return true;
-
-				if (recursive
-					&& T::registry.hierarchy[c].HasTarget(targetObject, true))
-				{
-					return true;
-				}
-			}
-
-			//check ancestors
-			if (parent)
-			{
-				if (parent == targetObject) return true;
-
-				if (recursive
-					&& T::registry.hierarchy[parent].HasTarget(targetObject, true))
-				{
-					return true;
-				}
-			}
-
-			return false;
+			return IsChild(targetObject, recursive)
+				|| IsParent(targetObject, recursive);
 		}
 		
 		inline bool IsParent(
 			T* targetObject,
 			bool recursive = false)
 		{
+			KalaGraphicsHierarchy<T>& target = T::registry.GetHierarchy(targetObject);
+
 			if (!thisObject
-				|| !targetObject
+				|| !target.thisObject
 				|| thisObject == targetObject)
 			{
 				return false;
 			}
 
-			if (!parent) return false;
-
-			if (parent == targetObject) return true;
-
-			if (recursive
-				&& T::registry.hierarchy[parent].IsParent(targetObject, true))
-			{
-				return true;
-			}
+			if (parent == target.self) return true;
 
-			return false;
+			return recursive
+				&& IsAncestor(target.self, self);
 		}
-		inline T* GetParent() { return parent; }
+		inline T* GetParent() 
+		{ 
+			return parent != REGISTRY_INVALID_INDEX
+				? T::registry.hierarchy[parent].thisObject
+				: nullptr;
+		}
+		//Attaches this target to a new parent, detaching it from its old parent first.
+		//Fails if the new parent is already the parent or if it would create a cycle
 		inline bool SetParent(T* targetObject)
 		{
+			KalaGraphicsHierarchy<T>& target = T::registry.GetHierarchy(targetObject);
+
 			if (!thisObject
-				|| !targetObject
+				|| !target.thisObject
 				|| targetObject == thisObject
-				|| HasTarget(targetObject, true)
-				|| T::registry.hierarchy[targetObject].HasTarget(thisObject, true)
-				|| (parent
-				&& (parent == targetObject
-				|| T::registry.hierarchy[parent].HasTarget(thisObject, true))))
+				|| parent == target.self
+				|| IsAncestor(self, target.self))
 			{
 				return false;
 			}
 			
 			//remove existing parent if it exists
-			if (parent) RemoveParent();
+			if (parent != REGISTRY_INVALID_INDEX) RemoveParent();
 
-			//set this target parent
-			parent = targetObject;
 			//add this as new child to parent
-			T::registry.hierarchy[parent].children.push_back(thisObject);
+			target.LinkChild(self);
 
 			return true;
 		}
@@ -132,20 +328,12 @@ namespace KalaGraphics::Utils
 		{
 			//skip if parent never even existed
 			if (!thisObject
-				|| !parent)
+				|| parent == REGISTRY_INVALID_INDEX)
 			{
 				return false;
 			}
 
-			vector<T*>& parentChildren = T::registry.hierarchy[parent].children;
-
-			parentChildren.erase(remove(
-				parentChildren.begin(),
-				parentChildren.end(),
-				thisObject),
-				parentChildren.end());
-
-			parent = nullptr;
+			T::registry.hierarchy[parent].UnlinkChild(self);
 
 			return true;
 		}
@@ -154,39 +342,39 @@ namespace KalaGraphics::Utils
 			T* targetObject,
 			bool recursive = false)
 		{
+			KalaGraphicsHierarchy<T>& target = T::registry.GetHierarchy(targetObject);
+
 			if (!thisObject
-				|| !targetObject
+				|| !target.thisObject
 				|| thisObject == targetObject)
 			{
 				return false;
 			}
 
-			for (auto* c : children)
-			{
-				if (c == targetObject) return true;
-
-				if (recursive
-					&& T::registry.hierarchy[c].IsChild(targetObject, true))
-				{
-					return true;
-				}
-			}
+			if (target.parent == self) return true;
 
-			return false;
+			//a descendant always has this target in its ancestor chain
+			return recursive
+				&& IsAncestor(self, target.self);
 		}
+		//Attaches the target as the last child of this target, detaching it from its old parent first.
+		//Fails if the target already is a child or if it would create a cycle
 		inline bool AddChild(T* targetObject)
 		{
+			KalaGraphicsHierarchy<T>& target = T::registry.GetHierarchy(targetObject);
+
 			if (!thisObject
-				|| !targetObject
+				|| !target.thisObject
 				|| targetObject == thisObject
-				|| HasTarget(targetObject, true)
-				|| T::registry.hierarchy[targetObject].HasTarget(thisObject, true))
+				|| target.parent == self
+				|| IsAncestor(target.self, self))
 			{
 				return false;
 			}
 
-			children.push_back(targetObject);
-			T::registry.hierarchy[targetObject].parent = thisObject;
+			if (target.parent != REGISTRY_INVALID_INDEX) target.RemoveParent();
+
+			LinkChild(target.self);
 
 			return true;
 		}
@@ -194,226 +382,1133 @@ namespace KalaGraphics::Utils
 			T* targetObject,
 			bool isDestructive = false)
 		{
+			KalaGraphicsHierarchy<T>& target = T::registry.GetHierarchy(targetObject);
+
 			if (!thisObject
-				|| !targetObject
+				|| !target.thisObject
 				|| targetObject == thisObject
-				|| (parent
-				&& targetObject == parent))
+				|| target.parent != self)
 			{
 				return false;
 			}
 
-			if (T::registry.hierarchy[targetObject].parent)
-			{
-				T::registry.hierarchy[targetObject].parent = nullptr;
-			}
-
-			if (isDestructive) T::registry.RemoveContent(targetObject, true);
+			UnlinkChild(target.self);
 
-			children.erase(remove(
-				children.begin(),
-				children.end(),
-				targetObject),
-				children.end());
+			if (isDestructive) T::registry.RemoveContent(targetObject);
 
 			return true;
 		}
 
-		inline const vector<T*>& GetAllChildren() 
+		inline u32 GetChildCount() const { return childCount; }
+
+		//Returns all direct children in the order they were attached
+		inline vector<T*> GetAllChildren() 
 		{
-			static const vector<T*> empty{};
-			return thisObject ? children : empty;
+			vector<T*> out{};
+			if (!thisObject) return out;
+
+			out.reserve(childCount);
+			for (u32 c = firstChild; c != REGISTRY_INVALID_INDEX; c = T::registry.hierarchy[c].nextSibling)
+			{
+				out.push_back(T::registry.hierarchy[c].thisObject);
+			}
+
+			return out;
 		}
 		inline void RemoveAllChildren(bool isDestructive = false)
 		{
 			if (!thisObject) return;
 
-			for (auto* c : children)
+			u32 c = firstChild;
+			while (c != REGISTRY_INVALID_INDEX)
 			{
-				T::registry.hierarchy[c].parent = nullptr;
+				KalaGraphicsHierarchy<T>& child = T::registry.hierarchy[c];
+				u32 next = child.nextSibling;
+
+				child.parent = REGISTRY_INVALID_INDEX;
+				child.prevSibling = REGISTRY_INVALID_INDEX;
+				child.nextSibling = REGISTRY_INVALID_INDEX;
+
+				if constexpr (HasRegistryParentHook<T>) child.thisObject->OnParentChanged();
 				
-				if (isDestructive) T::registry.RemoveContent(c, true);
+				if (isDestructive) T::registry.RemoveContent(child.thisObject);
+
+				c = next;
 			}				
 			
-			children.clear();
+			firstChild = REGISTRY_INVALID_INDEX;
+			lastChild = REGISTRY_INVALID_INDEX;
+			childCount = 0;
+
+			T::registry.isTraversalDirty = true;
+		}
+
+		//Queues this target and all its descendants for removal at the next FlushRemovedContent call
+		inline u32 DestroySubtree()
+		{
+			if (!thisObject) return 0;
+
+			return T::registry.RemoveSubtree(thisObject);
+		}
+
+		//Appends the child slot to the end of this node's child list, O(1)
+		inline void LinkChild(u32 childSlot)
+		{
+			KalaGraphicsHierarchy<T>& child = T::registry.hierarchy[childSlot];
+
+			child.parent = self;
+			child.prevSibling = lastChild;
+			child.nextSibling = REGISTRY_INVALID_INDEX;
+
+			if (lastChild != REGISTRY_INVALID_INDEX)
+			{
+				T::registry.hierarchy[lastChild].nextSibling = childSlot;
+			}
+			else firstChild = childSlot;
+
+			lastChild = childSlot;
+			++childCount;
+
+			T::registry.isTraversalDirty = true;
+
+			if constexpr (HasRegistryParentHook<T>) child.thisObject->OnParentChanged();
+		}
+		//Removes the child slot from this node's child list by patching its siblings, O(1)
+		inline void UnlinkChild(u32 childSlot)
+		{
+			KalaGraphicsHierarchy<T>& child = T::registry.hierarchy[childSlot];
+
+			if (child.prevSibling != REGISTRY_INVALID_INDEX)
+			{
+				T::registry.hierarchy[child.prevSibling].nextSibling = child.nextSibling;
+			}
+			else firstChild = child.nextSibling;
+
+			if (child.nextSibling != REGISTRY_INVALID_INDEX)
+			{
+				T::registry.hierarchy[child.nextSibling].prevSibling = child.prevSibling;
+			}
+			else lastChild = child.prevSibling;
+
+			child.parent = REGISTRY_INVALID_INDEX;
+			child.prevSibling = REGISTRY_INVALID_INDEX;
+			child.nextSibling = REGISTRY_INVALID_INDEX;
+			--childCount;
+
+			T::registry.isTraversalDirty = true;
+
+			if constexpr (HasRegistryParentHook<T>) child.thisObject->OnParentChanged();
 		}
 	};
 
-	//Stores unique_ptrs and non-owning pointers of class T for ID-based lookups,
-	//should always be stored as 'static inline KalaGraphicsRegistry<T> registry'
+	//Stores a parent pointer and a children vector per T instance inside the Registry struct.
+	//Works with every storage because links are pointers, detaching scans the children of the parent
 	template<typename T>
 		requires is_class_v<T>
-	struct LIB_API KalaGraphicsRegistry
+	struct LIB_API KalaGraphicsVectorHierarchy
 	{
-		//Owner registry with ID as key
-		static inline unordered_map<u32, unique_ptr<T>> createdContent{};
-		//Runtime non-owning pointers
-		static inline vector<T*> runtimeContent{};
-		//Hierarchy content for storing parent-child relations per instance of this class
-		static inline unordered_map<T*, KalaGraphicsHierarchy<T>> hierarchy{};
+		T* thisObject{};
+		T* parent{};
+		vector<T*> children{};
 
-		//Get non-owning value by ID
-		static inline T* GetContent(u32 targetID)
+		u32 traversalIndex = REGISTRY_INVALID_INDEX; //position in the cached traversal order, valid only while it is not dirty
+
+		//Returns the top-most parent of this target
+		inline T* GetRoot()
 		{
-			auto it = createdContent.find(targetID);
-			return it != createdContent.end()
-				? it->second.get()
-				: nullptr;
+			if (!thisObject) return nullptr;
+
+			T* current = thisObject;
+			while (T* next = T::registry.GetHierarchy(current).parent) current = next;
+
+			return current;
 		}
 
-		//Add a new unique ptr and its ID
-		static inline bool AddContent(
-			u32 targetID,
-			unique_ptr<T> targetContent)
+		//Returns true if the ancestor is found by walking up the parent chain of the target, O(depth)
+		static inline bool IsAncestor(
+			T* ancestor,
+			T* target)
 		{
-			if (!targetContent
-				|| targetID == 0
-				|| createdContent.contains(targetID))
+			if (!ancestor
+				|| !target)
 			{
 				return false;
 			}
 
-			T* raw = targetContent.get();
-			createdContent[targetID] = move(targetContent);
-			runtimeContent.push_back(raw);
-			
-			//add hierarchy node
-			hierarchy[raw] = KalaGraphicsHierarchy<T>{};
-			hierarchy[raw].thisObject = raw;
+			for (T* current = T::registry.GetHierarchy(target).parent;
+				current;
+				current = T::registry.GetHierarchy(current).parent)
+			{
+				if (current == ancestor) return true;
+			}
 
-			return true;
+			return false;
 		}
 
-		//Remove content by ID
-		static inline bool RemoveContent(u32 targetID)
+		//Returns true if target target is connected
+		//to current target as a child or parent.
+		//Set recursive to true if you want deep target search
+		inline bool HasTarget(
+			T* targetObject,
+			bool recursive = false)
 		{
-			T* targetPtr{};
-			
-			auto it = createdContent.find(targetID);
-			if (it != createdContent.end()) targetPtr = it->second.get();
-			
-			//erase from hierarchy
-			if (targetPtr)
+			if (!thisObject
+				|| !targetObject)
 			{
-				hierarchy.erase(targetPtr);
-				
-				for (auto& [obj, node] : hierarchy)
-				{
-					node.children.erase(remove(
-						node.children.begin(),
-						node.children.end(),
-						targetPtr),
-						node.children.end());
-						
-					if (node.parent == targetPtr) node.parent = nullptr;
-				}	
+				return false;
 			}
-			
-			runtimeContent.erase(
-				remove_if(runtimeContent.begin(), runtimeContent.end(),
-					[&](T* p)
-					{
-						return p && p->GetID() == targetID;
-					}),
-				runtimeContent.end());
 
-			createdContent.erase(targetID);
+			if (thisObject == targetObject) return true;
 
-			return true;
+			return IsChild(targetObject, recursive)
+				|| IsParent(targetObject, recursive);
 		}
-		//Remove content by non-owning pointer
-		static inline bool RemoveContent(
-			T* targetPtr,
-			bool removedViaHierarchy = false)
-		{
-			if (!targetPtr) return false;
 
-			//skip early if target ptr wasnt even found from runtime content vector
-			if (find(runtimeContent.begin(),
-				runtimeContent.end(),
-				targetPtr)
-				== runtimeContent.end())
+		inline bool IsParent(
+			T* targetObject,
+			bool recursive = false)
+		{
+			if (!thisObject
+				|| !T::registry.GetHierarchy(targetObject).thisObject
+				|| thisObject == targetObject)
 			{
 				return false;
 			}
-			
-			if (!removedViaHierarchy)
+
+			if (parent == targetObject) return true;
+
+			return recursive
+				&& IsAncestor(targetObject, thisObject);
+		}
+		inline T* GetParent() { return parent; }
+		//Attaches this target to a new parent, detaching it from its old parent first.
+		//Fails if the new parent is already the parent or if it would create a cycle
+		inline bool SetParent(T* targetObject)
+		{
+			KalaGraphicsVectorHierarchy<T>& target = T::registry.GetHierarchy(targetObject);
+
+			if (!thisObject
+				|| !target.thisObject
+				|| targetObject == thisObject
+				|| parent == targetObject
+				|| IsAncestor(thisObject, targetObject))
 			{
-				//erase from hierarchy
-				hierarchy.erase(targetPtr);
-				
-				for (auto& [obj, node] : hierarchy)
-				{
-					node.children.erase(remove(
-						node.children.begin(),
-						node.children.end(),
-						targetPtr),
-						node.children.end());
-						
-					if (node.parent == targetPtr) node.parent = nullptr;
-				}	
+				return false;
 			}
 
-			runtimeContent.erase(remove(
-				runtimeContent.begin(),
-				runtimeContent.end(),
-				targetPtr),
-				runtimeContent.end());
+			RemoveParent();
 
-			if (createdContent.contains(targetPtr->GetID()))
+			target.children.push_back(thisObject);
+			parent = targetObject;
+
+			T::registry.isTraversalDirty = true;
+
+			if constexpr (HasRegistryParentHook<T>) thisObject->OnParentChanged();
+
+			return true;
+		}
+		inline bool RemoveParent()
+		{
+			//skip if parent never even existed
+			if (!thisObject
+				|| !parent)
 			{
-				createdContent.erase(targetPtr->GetID());
+				return false;
 			}
 
+			vector<T*>& siblings = T::registry.GetHierarchy(parent).children;
+			siblings.erase(remove(siblings.begin(), siblings.end(), thisObject), siblings.end());
+			parent = nullptr;
+
+			T::registry.isTraversalDirty = true;
+
+			if constexpr (HasRegistryParentHook<T>) thisObject->OnParentChanged();
+
 			return true;
 		}
 
-		static inline void RemoveAllContent()
-		{
-			hierarchy.clear();
-			createdContent.clear();
-			runtimeContent.clear();
-		}
-		
-		//
-		// WINDOW-RELATED ACTIONS
-		//
-		
-		//Returns true if the window owns the ID
-		//Requires target class inside createdContent and runtimeContent
-		//to have the 'u32 GetWindowID()' function.
-		//Should not be used for externally created registries
-		//because the Window class does not accept new IDs
-		template<typename U = T>
-			requires requires(U& u) { u.GetWindowID(); }
-		static inline bool IsOwner(
-			u32 windowID,
-			u32 targetID)
+		inline bool IsChild(
+			T* targetObject,
+			bool recursive = false)
 		{
-			auto it = createdContent.find(targetID);
-			if (it == createdContent.end()) return false;
+			KalaGraphicsVectorHierarchy<T>& target = T::registry.GetHierarchy(targetObject);
 
-			return it->second
-				&& it->second->GetWindowID() == windowID;
-		}
+			if (!thisObject
+				|| !target.thisObject
+				|| thisObject == targetObject)
+			{
+				return false;
+			}
+
+			if (target.parent == thisObject) return true;
+
+			return recursive
+				&& IsAncestor(thisObject, targetObject);
+		}
+		//Attaches the target as the last child of this target, detaching it from its old parent first.
+		//Fails if the target already is a child or if it would create a cycle
+		inline bool AddChild(T* targetObject)
+		{
+			KalaGraphicsVectorHierarchy<T>& target = T::registry.GetHierarchy(targetObject);
+
+			if (!thisObject
+				|| !target.thisObject
+				|| targetObject == thisObject
+				|| target.parent == thisObject
+				|| IsAncestor(targetObject, thisObject))
+			{
+				return false;
+			}
+
+			target.RemoveParent();
+
+			children.push_back(targetObject);
+			target.parent = thisObject;
+
+			T::registry.isTraversalDirty = true;
+
+			if constexpr (HasRegistryParentHook<T>) targetObject->OnParentChanged();
+
+			return true;
+		}
+		inline bool RemoveChild(
+			T* targetObject,
+			bool isDestructive = false)
+		{
+			KalaGraphicsVectorHierarchy<T>& target = T::registry.GetHierarchy(targetObject);
+
+			if (!thisObject
+				|| !target.thisObject
+				|| targetObject == thisObject
+				|| target.parent != thisObject)
+			{
+				return false;
+			}
+
+			target.RemoveParent();
+
+			//removal may move nodes around in hash map storage, so nothing is touched after it
+			if (isDestructive) T::registry.RemoveContent(targetObject);
+
+			return true;
+		}
+
+		inline u32 GetChildCount() const { return static_cast<u32>(children.size()); }
+
+		//Returns all direct children in the order they were attached
+		inline const vector<T*>& GetAllChildren() const { return children; }
+		inline void RemoveAllChildren(bool isDestructive = false)
+		{
+			if (!thisObject) return;
+
+			vector<T*> oldChildren{};
+			oldChildren.swap(children);
+
+			T::registry.isTraversalDirty = true;
+
+			//removal may move nodes around in hash map storage, so only the local copy is used from here on
+			for (T* c : oldChildren)
+			{
+				T::registry.GetHierarchy(c).parent = nullptr;
+
+				if constexpr (HasRegistryParentHook<T>) c->OnParentChanged();
+
+				if (isDestructive) T::registry.RemoveContent(c);
+			}
+		}
+
+		//Queues this target and all its descendants for removal at the next FlushRemovedContent call
+		inline u32 DestroySubtree()
+		{
+			if (!thisObject) return 0;
+
+			return T::registry.RemoveSubtree(thisObject);
+		}
+	};
+
+	//Placeholder node of registries without hierarchy support, never stored
+	struct LIB_API RegistryNoHierarchy {};
+
+	//Stores unique_ptrs and non-owning pointers of class T for ID-based lookups,
+	//should always be stored as 'static inline KalaGraphicsRegistry<T, Policy> registry'.
+	//Owners and runtime pointers are always densely packed and swap-removed,
+	//the policy picks how IDs reach them, how the hierarchy is linked and which threads may add content.
+	//The default policy is a generational slot map with intrusive hierarchy links.
+	//Objects themselves are not moved into the dense arrays, content is handed out as stable T* and
+	//derived widgets differ in size, classes that are walked every frame inherit KalaGraphicsPooled
+	//instead so their instances are packed into per-class chunks
+	template<typename T, typename Policy = RegistryPolicy<>>
+		requires is_class_v<T>
+	struct LIB_API KalaGraphicsRegistry
+	{
+		static constexpr bool isHashStorage = Policy::storage == RegistryStorage::STORAGE_HASH_MAP;
+		static constexpr bool isFixedStorage = Policy::storage == RegistryStorage::STORAGE_FIXED_ARRAY;
+		static constexpr bool hasHierarchy = Policy::hierarchy != RegistryHierarchy::HIERARCHY_NONE;
+		static constexpr bool isIntrusiveHierarchy = Policy::hierarchy == RegistryHierarchy::HIERARCHY_INTRUSIVE;
+		static constexpr bool isQueued = Policy::threading == RegistryThreading::THREADING_QUEUED;
+
+		using HierarchyNode = conditional_t<
+			isIntrusiveHierarchy,
+			KalaGraphicsHierarchy<T>,
+			conditional_t<
+				hasHierarchy,
+				KalaGraphicsVectorHierarchy<T>,
+				RegistryNoHierarchy>>;
+
+		//Node of the lock-free queued content stack
+		struct QueuedContent
+		{
+			u32 ID{};
+			unique_ptr<T> content{};
+			QueuedContent* next{};
+		};
+
+		//Owner storage, densely packed in the same order as runtimeContent.
+		//Only the owners are dense, each object lives in its class pool or on the heap
+		static inline vector<unique_ptr<T>> createdContent{};
+		//Runtime non-owning pointers, densely packed so it never needs compaction
+		static inline vector<T*> runtimeContent{};
+		//Slot index of each dense entry, used to patch the slot of swapped content on removal.
+		//Unused by hash map storage where slot and dense position are the same
+		static inline vector<u32> denseToSlot{};
+		//Sparse generational slots that handles point to
+		static inline vector<RegistrySlot> slots{};
+		//Head of the free slot list, reused before new slots are appended
+		static inline u32 firstFreeSlot = REGISTRY_INVALID_INDEX;
+		//ID to slot index lookup
+		static inline unordered_map<u32, u32> idToSlot{};
+		//Hierarchy nodes for storing parent-child relations per instance of this class, indexed by slot.
+		//Always empty if the policy has no hierarchy
+		static inline vector<HierarchyNode> hierarchy{};
+
+		//Flattened pre-order of every root and its descendants, roots follow the dense content order
+		static inline vector<KalaGraphicsTraversalEntry<T>> traversalOrder{};
+		//Set by every hierarchy link change, add and removal, the traversal order is rebuilt on next access
+		static inline bool isTraversalDirty = true;
+		//Bumped by every traversal order rebuild, caches indexed by traversal position compare against it
+		static inline u64 traversalRevision{};
+
+		//Content per window ID, only maintained if T has 'u32 GetWindowID()'
+		static inline unordered_map<u32, vector<T*>> windowIndex{};
+		//Content per name, only maintained if T has 'const string& GetName()'.
+		//Names are not unique so every name maps to all content that uses it
+		static inline unordered_map<string, vector<T*>, RegistryNameHash, equal_to<>> nameIndex{};
+
+		//Counters and latency histograms, only updated while isStatsEnabled is true
+		static inline RegistryStats stats{};
+		static inline bool isStatsEnabled{};
+
+		//IDs of content marked for removal, destroyed together by FlushRemovedContent.
+		//IDs are never reused so they can't go stale the way slot positions can
+		static inline vector<u32> pendingRemovals{};
+
+		//Content queued from other threads, a lock-free stack that only the main thread drains.
+		//Only used if the policy allows queued threading
+		static inline atomic<QueuedContent*> queuedContent{};
+
+		//Get non-owning value by ID
+		static inline T* GetContent(u32 targetID)
+		{
+			StatScope scope(RegistryStatTarget::STAT_LOOKUP);
+
+			auto it = idToSlot.find(targetID);
+			if (it == idToSlot.end())
+			{
+				scope.isMiss = true;
+				return nullptr;
+			}
+
+			return runtimeContent[slots[it->second].denseIndex];
+		}
+		//Get non-owning value by handle, returns nullptr if the handle is stale
+		static inline T* GetContent(RegistryHandle targetHandle)
+			requires (!isHashStorage)
+		{
+			StatScope scope(RegistryStatTarget::STAT_LOOKUP);
+
+			if (!IsValid(targetHandle))
+			{
+				scope.isMiss = true;
+				return nullptr;
+			}
+
+			return runtimeContent[slots[targetHandle.index].denseIndex];
+		}
+
+		//Returns the hierarchy node of this pointer.
+		//Unregistered pointers get an empty node that refuses every hierarchy action
+		static inline HierarchyNode& GetHierarchy(T* targetPtr)
+			requires hasHierarchy
+		{
+			static HierarchyNode empty{};
+
+			u32 slotIndex = FindSlot(targetPtr);
+			if (slotIndex == REGISTRY_INVALID_INDEX)
+			{
+				empty = {};
+				return empty;
+			}
+
+			return hierarchy[slotIndex];
+		}
+
+		//Returns all content as a dense non-owning view
+		static inline span<T* const> GetAllContent() { return runtimeContent; }
+
+		//Returns all content in parent-before-child order, rebuilt only if the hierarchy changed since the last call.
+		//The view is invalidated by the next hierarchy change, add or removal
+		static inline span<const KalaGraphicsTraversalEntry<T>> GetTraversalOrder()
+			requires hasHierarchy
+		{
+			if (isTraversalDirty) RebuildTraversalOrder();
+
+			return traversalOrder;
+		}
+		//Returns the contiguous traversal range of this target and all its descendants,
+		//the first entry is always the target itself. Unregistered pointers get an empty view
+		static inline span<const KalaGraphicsTraversalEntry<T>> GetSubtreeOrder(T* targetPtr)
+			requires hasHierarchy
+		{
+			u32 slotIndex = FindSlot(targetPtr);
+			if (slotIndex == REGISTRY_INVALID_INDEX) return {};
+
+			if (isTraversalDirty) RebuildTraversalOrder();
+
+			u32 start = hierarchy[slotIndex].traversalIndex;
+
+			return span<const KalaGraphicsTraversalEntry<T>>(traversalOrder)
+				.subspan(start, traversalOrder[start].subtreeSize);
+		}
+
+		//Returns the generational handle of this ID, or an invalid handle if the ID is not registered
+		static inline RegistryHandle GetHandle(u32 targetID)
+			requires (!isHashStorage)
+		{
+			u32 slotIndex = FindSlot(targetID);
+			if (slotIndex == REGISTRY_INVALID_INDEX) return {};
+
+			return { slotIndex, slots[slotIndex].generation };
+		}
+		//Returns the generational handle of this pointer, or an invalid handle if the pointer is not registered
+		static inline RegistryHandle GetHandle(T* targetPtr)
+			requires (!isHashStorage)
+		{
+			u32 slotIndex = FindSlot(targetPtr);
+			if (slotIndex == REGISTRY_INVALID_INDEX) return {};
+
+			return { slotIndex, slots[slotIndex].generation };
+		}
+
+		//Returns true if the handle still points to live content
+		static inline bool IsValid(RegistryHandle targetHandle)
+			requires (!isHashStorage)
+		{
+			return targetHandle.index < slots.size()
+				&& slots[targetHandle.index].generation == targetHandle.generation
+				&& slots[targetHandle.index].denseIndex != REGISTRY_INVALID_INDEX;
+		}
+
+		//Add a new unique ptr and its ID, main thread only.
+		//Use QueueContent to add content from other threads
+		static inline bool AddContent(
+			u32 targetID,
+			unique_ptr<T> targetContent)
+		{
+			if (!targetContent
+				|| targetID == 0
+				|| idToSlot.contains(targetID))
+			{
+				return false;
+			}
+
+			StatScope scope(RegistryStatTarget::STAT_INSERT);
+
+			//only fixed array storage can run out of slots
+			u32 slotIndex = AllocateSlot();
+			if (slotIndex == REGISTRY_INVALID_INDEX) return false;
+
+			RegistrySlot& slot = slots[slotIndex];
+			slot.denseIndex = static_cast<u32>(runtimeContent.size());
+			slot.ID = targetID;
+
+			T* raw = targetContent.get();
+			createdContent.push_back(move(targetContent));
+			runtimeContent.push_back(raw);
+			if constexpr (!isHashStorage) denseToSlot.push_back(slotIndex);
+
+			idToSlot[targetID] = slotIndex;
 			
-		//Get all content as non-owning pointers by window ID from containers.
+			//reset hierarchy node
+			if constexpr (hasHierarchy)
+			{
+				hierarchy[slotIndex] = HierarchyNode{};
+				hierarchy[slotIndex].thisObject = raw;
+				if constexpr (isIntrusiveHierarchy) hierarchy[slotIndex].self = slotIndex;
+
+				isTraversalDirty = true;
+			}
+
+			IndexContent(slotIndex);
+
+			return true;
+		}
+
+		//Add many unique ptrs and their IDs at once, main thread only.
+		//All containers are grown once up front instead of per content.
+		//Returns the amount of added content, pairs with a null ptr or an already registered ID are skipped
+		static inline u32 AddContents(
+			span<const u32> targetIDs,
+			span<unique_ptr<T>> targetContents)
+		{
+			size_t count = targetIDs.size() < targetContents.size()
+				? targetIDs.size()
+				: targetContents.size();
+
+			//fixed array storage already reserved its full capacity
+			if constexpr (!isFixedStorage)
+			{
+				size_t newSize = runtimeContent.size() + count;
+				createdContent.reserve(newSize);
+				runtimeContent.reserve(newSize);
+				if constexpr (!isHashStorage) denseToSlot.reserve(newSize);
+				idToSlot.reserve(newSize);
+				if (slots.size() < newSize)
+				{
+					slots.reserve(newSize);
+					if constexpr (hasHierarchy) hierarchy.reserve(newSize);
+				}
+			}
+
+			u32 addedCount{};
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (AddContent(targetIDs[i], move(targetContents[i]))) ++addedCount;
+			}
+
+			return addedCount;
+		}
+
+		//Queue a new unique ptr and its ID from any thread, lock-free.
+		//Queued content is not visible to lookups until the main thread calls FlushQueuedContent,
+		//the main thread containers are never touched here so its reads stay wait-free
+		static inline bool QueueContent(
+			u32 targetID,
+			unique_ptr<T> targetContent)
+			requires isQueued
+		{
+			if (!targetContent
+				|| targetID == 0)
+			{
+				return false;
+			}
+
+			QueuedContent* node = new QueuedContent{ targetID, move(targetContent), nullptr };
+			node->next = queuedContent.load(memory_order_relaxed);
+
+			while (!queuedContent.compare_exchange_weak(
+				node->next,
+				node,
+				memory_order_release,
+				memory_order_relaxed)) {}
+
+			return true;
+		}
+
+		//Returns true if other threads have queued content that is not yet flushed
+		static inline bool HasQueuedContent()
+			requires isQueued
+		{
+			return queuedContent.load(memory_order_relaxed) != nullptr;
+		}
+
+		//Moves all queued content into the registry in the order it was queued,
+		//must only be called from the main thread. Returns the amount of added content,
+		//queued content with an already registered ID is destroyed
+		static inline u32 FlushQueuedContent()
+			requires isQueued
+		{
+			QueuedContent* head = queuedContent.exchange(nullptr, memory_order_acquire);
+
+			//the stack is newest first, reverse it to keep queue order
+			QueuedContent* ordered{};
+			while (head)
+			{
+				QueuedContent* next = head->next;
+				head->next = ordered;
+				ordered = head;
+				head = next;
+			}
+
+			u32 addedCount{};
+			while (ordered)
+			{
+				QueuedContent* next = ordered->next;
+
+				if (AddContent(ordered->ID, move(ordered->content))) ++addedCount;
+
+				delete ordered;
+				ordered = next;
+			}
+
+			return addedCount;
+		}
+
+		//Mark content by ID for removal at the next FlushRemovedContent call.
+		//Marked content stays alive and reachable until then
+		static inline bool MarkForRemoval(u32 targetID)
+		{
+			auto it = idToSlot.find(targetID);
+			if (it == idToSlot.end()) return false;
+
+			RegistrySlot& slot = slots[it->second];
+			if (slot.isPendingRemoval) return false;
+
+			slot.isPendingRemoval = true;
+			pendingRemovals.push_back(targetID);
+
+			return true;
+		}
+
+		//Mark many IDs for removal at once, returns the amount of newly marked content
+		static inline u32 RemoveContents(span<const u32> targetIDs)
+		{
+			pendingRemovals.reserve(pendingRemovals.size() + targetIDs.size());
+
+			u32 markedCount{};
+			for (u32 id : targetIDs)
+			{
+				if (MarkForRemoval(id)) ++markedCount;
+			}
+
+			return markedCount;
+		}
+
+		//Mark the target and all its descendants for removal, the subtree is read
+		//straight from the cached traversal order. Returns the amount of newly marked content
+		static inline u32 RemoveSubtree(T* targetPtr)
+			requires hasHierarchy
+		{
+			span<const KalaGraphicsTraversalEntry<T>> subtree = GetSubtreeOrder(targetPtr);
+
+			pendingRemovals.reserve(pendingRemovals.size() + subtree.size());
+
+			u32 markedCount{};
+			for (const auto& entry : subtree)
+			{
+				if (MarkForRemoval(slots[entry.slot].ID)) ++markedCount;
+			}
+
+			return markedCount;
+		}
+
+		//Returns true if this content is waiting for FlushRemovedContent
+		static inline bool IsPendingRemoval(u32 targetID)
+		{
+			auto it = idToSlot.find(targetID);
+
+			return it != idToSlot.end()
+				&& slots[it->second].isPendingRemoval;
+		}
+
+		//Destroys all content marked for removal, should be called once at the end of the frame.
+		//Large batches are compacted in a single linear pass over the dense containers which keeps
+		//the order of the remaining content, small batches fall back to per content swap-removal.
+		//Returns the amount of destroyed content
+		static inline u32 FlushRemovedContent()
+		{
+			if (pendingRemovals.empty()) return 0;
+
+			//destructors may mark more content, that content waits for the next flush
+			vector<u32> batch{};
+			batch.swap(pendingRemovals);
+
+			//content removed directly after being marked is no longer found
+			u32 removedCount{};
+			for (u32 id : batch)
+			{
+				if (IsPendingRemoval(id)) ++removedCount;
+			}
+
+			if (removedCount * 8 < runtimeContent.size())
+			{
+				for (u32 id : batch)
+				{
+					if (IsPendingRemoval(id)) EraseSlot(FindSlot(id));
+				}
+
+				RecycleRemovalBatch(batch);
+
+				return removedCount;
+			}
+
+			//timed until the owners are destroyed, so teardown stalls show up in the remove latency
+			StatScope scope(RegistryStatTarget::STAT_REMOVE);
+			scope.count = removedCount;
+
+			for (u32 id : batch)
+			{
+				if (!IsPendingRemoval(id)) continue;
+
+				u32 slotIndex = FindSlot(id);
+				UnindexContent(slotIndex);
+				if constexpr (hasHierarchy) DetachHierarchy(slotIndex);
+			}
+
+			//owners are collected and destroyed last so their destructors see a consistent registry
+			vector<unique_ptr<T>> removed{};
+			removed.reserve(removedCount);
+
+			u32 writeIndex{};
+			for (u32 readIndex = 0; readIndex < runtimeContent.size(); ++readIndex)
+			{
+				u32 slotIndex = SlotOf(readIndex);
+				RegistrySlot& slot = slots[slotIndex];
+
+				if (slot.isPendingRemoval)
+				{
+					removed.push_back(move(createdContent[readIndex]));
+					idToSlot.erase(slot.ID);
+					if constexpr (!isHashStorage) FreeSlot(slotIndex);
+
+					continue;
+				}
+
+				if (writeIndex != readIndex)
+				{
+					createdContent[writeIndex] = move(createdContent[readIndex]);
+					runtimeContent[writeIndex] = runtimeContent[readIndex];
+
+					//hash map slots and nodes travel with their content
+					if constexpr (isHashStorage)
+					{
+						slots[writeIndex] = slot;
+						slots[writeIndex].denseIndex = writeIndex;
+						idToSlot[slots[writeIndex].ID] = writeIndex;
+						if constexpr (hasHierarchy) hierarchy[writeIndex] = move(hierarchy[readIndex]);
+					}
+					else
+					{
+						denseToSlot[writeIndex] = slotIndex;
+						slot.denseIndex = writeIndex;
+					}
+				}
+				++writeIndex;
+			}
+
+			createdContent.resize(writeIndex);
+			runtimeContent.resize(writeIndex);
+			if constexpr (isHashStorage)
+			{
+				slots.resize(writeIndex);
+				if constexpr (hasHierarchy) hierarchy.resize(writeIndex);
+			}
+			else denseToSlot.resize(writeIndex);
+
+			isTraversalDirty = true;
+
+			removed.clear();
+			RecycleRemovalBatch(batch);
+
+			return removedCount;
+		}
+
+		//Remove content by ID
+		static inline bool RemoveContent(u32 targetID)
+		{
+			auto it = idToSlot.find(targetID);
+			if (it == idToSlot.end()) return false;
+
+			EraseSlot(it->second);
+
+			return true;
+		}
+		//Remove content by handle, stale handles are ignored
+		static inline bool RemoveContent(RegistryHandle targetHandle)
+			requires (!isHashStorage)
+		{
+			if (!IsValid(targetHandle)) return false;
+
+			return RemoveContent(slots[targetHandle.index].ID);
+		}
+		//Remove content by non-owning pointer
+		static inline bool RemoveContent(T* targetPtr)
+		{
+			u32 slotIndex = FindSlot(targetPtr);
+
+			//skip early if target ptr wasnt even registered
+			if (slotIndex == REGISTRY_INVALID_INDEX) return false;
+
+			EraseSlot(slotIndex);
+
+			return true;
+		}
+
+		static inline void RemoveAllContent()
+		{
+			//queued content is dropped too
+			QueuedContent* head = queuedContent.exchange(nullptr, memory_order_acquire);
+			while (head)
+			{
+				QueuedContent* next = head->next;
+				delete head;
+				head = next;
+			}
+
+			traversalOrder.clear();
+			pendingRemovals.clear();
+			windowIndex.clear();
+			nameIndex.clear();
+			isTraversalDirty = true;
+			idToSlot.clear();
+			denseToSlot.clear();
+			runtimeContent.clear();
+			createdContent.clear();
+
+			if constexpr (isHashStorage)
+			{
+				slots.clear();
+				hierarchy.clear();
+
+				return;
+			}
+
+			for (auto& node : hierarchy) node = HierarchyNode{};
+
+			//bump all generations so every previously handed out handle goes stale
+			firstFreeSlot = REGISTRY_INVALID_INDEX;
+			for (u32 i = static_cast<u32>(slots.size()); i > 0; --i)
+			{
+				RegistrySlot& slot = slots[i - 1];
+				slot.denseIndex = REGISTRY_INVALID_INDEX;
+				slot.ID = 0;
+				slot.isPendingRemoval = false;
+				slot.windowPosition = REGISTRY_INVALID_INDEX;
+				slot.namePosition = REGISTRY_INVALID_INDEX;
+				++slot.generation;
+				slot.nextFree = firstFreeSlot;
+				firstFreeSlot = i - 1;
+			}
+		}
+		
+		//
+		// STATS
+		//
+
+		//Toggle stats collection for this registry. Disabled registries only pay
+		//a single branch per insert, removal and lookup. Enabling resets all counters
+		static inline void SetStatsState(bool newState)
+		{
+			if (newState && !isStatsEnabled)
+			{
+				stats = RegistryStats{};
+				stats.peakCount = static_cast<u32>(runtimeContent.size());
+			}
+
+			isStatsEnabled = newState;
+		}
+		static inline bool IsStatsEnabled() { return isStatsEnabled; }
+
+		//Returns a snapshot of the counters with the live count and byte totals filled in.
+		//Byte totals walk all content, so call this at telemetry rate rather than every frame
+		static inline RegistryStats GetStats()
+		{
+			RegistryStats out = stats;
+			out.liveCount = static_cast<u32>(runtimeContent.size());
+			if (out.peakCount < out.liveCount) out.peakCount = out.liveCount;
+
+			out.contentBytes = 0;
+			for (const T* content : runtimeContent)
+			{
+				if constexpr (HasRegistryMemoryUsage<T>) out.contentBytes += content->GetMemoryUsage();
+				else out.contentBytes += sizeof(T);
+			}
+
+			//hash map nodes are estimated as key, value and one next pointer per node plus one pointer per bucket
+			auto mapBytes = [](const auto& map, size_t valueBytes)
+				{
+					return map.size() * (valueBytes + sizeof(void*)) + map.bucket_count() * sizeof(void*);
+				};
+
+			out.containerBytes =
+				createdContent.capacity() * sizeof(unique_ptr<T>)
+				+ runtimeContent.capacity() * sizeof(T*)
+				+ denseToSlot.capacity() * sizeof(u32)
+				+ slots.capacity() * sizeof(RegistrySlot)
+				+ hierarchy.capacity() * sizeof(HierarchyNode)
+				+ traversalOrder.capacity() * sizeof(KalaGraphicsTraversalEntry<T>)
+				+ pendingRemovals.capacity() * sizeof(u32)
+				+ mapBytes(idToSlot, sizeof(u32) * 2)
+				+ mapBytes(windowIndex, sizeof(u32) + sizeof(vector<T*>))
+				+ mapBytes(nameIndex, sizeof(string) + sizeof(vector<T*>));
+
+			for (const auto& [windowID, bucket] : windowIndex) out.containerBytes += bucket.capacity() * sizeof(T*);
+			for (const auto& [name, bucket] : nameIndex)
+			{
+				out.containerBytes += name.capacity() + bucket.capacity() * sizeof(T*);
+			}
+
+			return out;
+		}
+
+		//Clears all counters and histograms but keeps stats enabled or disabled as they were
+		static inline void ResetStats()
+		{
+			stats = RegistryStats{};
+			stats.peakCount = static_cast<u32>(runtimeContent.size());
+		}
+
+		//Returns the current stats as human readable text or as a single JSON object.
+		//Label defaults to the type name of T
+		static inline string DumpStats(
+			bool asJson = false,
+			string_view label = {})
+		{
+			RegistryStats s = GetStats();
+			string name = label.empty() ? string(typeid(T).name()) : string(label);
+
+			//trailing empty buckets are trimmed so dumps stay short
+			auto histogram = [asJson](const array<u64, REGISTRY_LATENCY_BUCKETS>& buckets)
+				{
+					u32 last = REGISTRY_LATENCY_BUCKETS;
+					while (last > 0 && buckets[last - 1] == 0) --last;
+
+					string out = asJson ? "[" : "";
+					for (u32 i = 0; i < last; ++i)
+					{
+						if (asJson)
+						{
+							if (i > 0) out += ",";
+							out += to_string(buckets[i]);
+						}
+						else if (buckets[i] > 0)
+						{
+							out += " <" + to_string(u64(1) << i) + "ns:" + to_string(buckets[i]);
+						}
+					}
+					if (asJson) out += "]";
+
+					return out;
+				};
+
+			if (asJson)
+			{
+				string escaped{};
+				for (char c : name)
+				{
+					if (c == '"' || c == '\\') escaped += '\\';
+					escaped += c;
+				}
+
+				return "{\"registry\":\"" + escaped + "\""
+					+ ",\"enabled\":" + (isStatsEnabled ? "true" : "false")
+					+ ",\"live\":" + to_string(s.liveCount)
+					+ ",\"peak\":" + to_string(s.peakCount)
+					+ ",\"contentBytes\":" + to_string(s.contentBytes)
+					+ ",\"containerBytes\":" + to_string(s.containerBytes)
+					+ ",\"inserts\":" + to_string(s.insertCount)
+					+ ",\"removes\":" + to_string(s.removeCount)
+					+ ",\"lookups\":" + to_string(s.lookupCount)
+					+ ",\"lookupMisses\":" + to_string(s.lookupMissCount)
+					+ ",\"insertLatencyLog2Ns\":" + histogram(s.insertLatency)
+					+ ",\"removeLatencyLog2Ns\":" + histogram(s.removeLatency)
+					+ ",\"lookupLatencyLog2Ns\":" + histogram(s.lookupLatency)
+					+ "}";
+			}
+
+			return "registry '" + name + "'" + (isStatsEnabled ? "" : " (stats disabled)") + "\n"
+				+ "  live: " + to_string(s.liveCount) + ", peak: " + to_string(s.peakCount) + "\n"
+				+ "  bytes: content " + to_string(s.contentBytes) + ", containers " + to_string(s.containerBytes) + "\n"
+				+ "  inserts: " + to_string(s.insertCount)
+				+ ", removes: " + to_string(s.removeCount)
+				+ ", lookups: " + to_string(s.lookupCount)
+				+ " (misses " + to_string(s.lookupMissCount) + ")\n"
+				+ "  insert latency:" + histogram(s.insertLatency) + "\n"
+				+ "  remove latency:" + histogram(s.removeLatency) + "\n"
+				+ "  lookup latency:" + histogram(s.lookupLatency);
+		}
+
+		//
+		// NAME-RELATED ACTIONS
+		//
+
+		//Returns all content that currently uses this name as a non-owning view, empty if none do.
+		//The view is invalidated by the next add, removal or rename
+		template<typename U = T>
+			requires HasRegistryName<U>
+		static inline span<T* const> GetAllContentByName(string_view targetName)
+		{
+			auto it = nameIndex.find(targetName);
+			if (it == nameIndex.end()) return {};
+
+			return it->second;
+		}
+		//Returns the first content that uses this name, or nullptr if none do
+		template<typename U = T>
+			requires HasRegistryName<U>
+		static inline T* GetContentByName(string_view targetName)
+		{
+			StatScope scope(RegistryStatTarget::STAT_LOOKUP);
+
+			auto it = nameIndex.find(targetName);
+			if (it == nameIndex.end())
+			{
+				scope.isMiss = true;
+				return nullptr;
+			}
+
+			return it->second.front();
+		}
+
+		//Moves registered content from the old name bucket to the bucket of its current name.
+		//Must be called by 'SetName' after the name has changed, unregistered content is ignored
+		template<typename U = T>
+			requires HasRegistryName<U>
+		static inline void UpdateNameIndex(
+			T* targetPtr,
+			string_view oldName)
+		{
+			u32 slotIndex = FindSlot(targetPtr);
+			if (slotIndex == REGISTRY_INVALID_INDEX) return;
+
+			RemoveFromIndex(nameIndex, oldName, slotIndex, &RegistrySlot::namePosition);
+			AddToIndex(nameIndex, targetPtr->GetName(), slotIndex, &RegistrySlot::namePosition);
+		}
+
+		//
+		// WINDOW-RELATED ACTIONS
+		//
+		
+		//Returns true if the window owns the ID
 		//Requires target class inside createdContent and runtimeContent
 		//to have the 'u32 GetWindowID()' function.
 		//Should not be used for externally created registries
 		//because the Window class does not accept new IDs
 		template<typename U = T>
 			requires requires(U& u) { u.GetWindowID(); }
-		static inline vector<T*> GetAllWindowContent(u32 windowID)
+		static inline bool IsOwner(
+			u32 windowID,
+			u32 targetID)
 		{
-			vector<T*> out{};
+			T* content = GetContent(targetID);
 
-			for (const auto& v : runtimeContent)
-			{
-				if (v->GetWindowID() == windowID) out.push_back(v);
-			}
-				
-			return out;
+			return content
+				&& content->GetWindowID() == windowID;
+		}
+			
+		//Get all content of this window as a non-owning view, empty if the window owns nothing.
+		//Requires target class inside createdContent and runtimeContent
+		//to have the 'u32 GetWindowID()' function.
+		//Should not be used for externally created registries
+		//because the Window class does not accept new IDs.
+		//The view is invalidated by the next add or removal
+		template<typename U = T>
+			requires requires(U& u) { u.GetWindowID(); }
+		static inline span<T* const> GetAllWindowContent(u32 windowID)
+		{
+			auto it = windowIndex.find(windowID);
+			if (it == windowIndex.end()) return {};
+
+			return it->second;
 		}
 
 		//Remove all content by window ID from containers.
@@ -425,21 +1520,408 @@ namespace KalaGraphics::Utils
 			requires requires(U& u) { u.GetWindowID(); }
 		static inline void RemoveAllWindowContent(u32 windowID)
 		{
-			runtimeContent.erase(remove_if(
-				runtimeContent.begin(),
-				runtimeContent.end(),
-				[&](T* c)
+			//each removal shrinks the bucket and drops it once empty
+			for (auto it = windowIndex.find(windowID);
+				it != windowIndex.end();
+				it = windowIndex.find(windowID))
+			{
+				RemoveContent(it->second.back());
+			}
+		}
+	private:
+		//Times one registry operation while stats are enabled, costs a single branch otherwise
+		struct StatScope
+		{
+			RegistryStatTarget target{};
+			bool isTimed{};
+			bool isMiss{};
+			//operations covered by this one sample
+			u32 count = 1;
+			steady_clock::time_point start{};
+
+			StatScope(RegistryStatTarget newTarget)
+				: target(newTarget),
+				isTimed(isStatsEnabled)
+			{
+				if (isTimed) start = steady_clock::now();
+			}
+			~StatScope()
+			{
+				if (isTimed) RecordStat(target, start, isMiss, count);
+			}
+		};
+
+		static inline void RecordStat(
+			RegistryStatTarget target,
+			steady_clock::time_point start,
+			bool isMiss,
+			u32 count = 1)
+		{
+			u64 elapsed = static_cast<u64>(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+			u32 bucket = static_cast<u32>(bit_width(elapsed));
+			if (bucket >= REGISTRY_LATENCY_BUCKETS) bucket = REGISTRY_LATENCY_BUCKETS - 1;
+
+			switch (target)
+			{
+			case RegistryStatTarget::STAT_INSERT:
+			{
+				++stats.insertCount;
+				++stats.insertLatency[bucket];
+
+				u32 liveCount = static_cast<u32>(runtimeContent.size());
+				if (stats.peakCount < liveCount) stats.peakCount = liveCount;
+				break;
+			}
+			case RegistryStatTarget::STAT_REMOVE:
+				stats.removeCount += count;
+				++stats.removeLatency[bucket];
+				break;
+			case RegistryStatTarget::STAT_LOOKUP:
+				++stats.lookupCount;
+				++stats.lookupLatency[bucket];
+				if (isMiss) ++stats.lookupMissCount;
+				break;
+			}
+		}
+
+		//Returns the slot of this ID, or REGISTRY_INVALID_INDEX if the ID is not registered
+		static inline u32 FindSlot(u32 targetID)
+		{
+			auto it = idToSlot.find(targetID);
+
+			return it != idToSlot.end()
+				? it->second
+				: REGISTRY_INVALID_INDEX;
+		}
+		//Returns the slot of this pointer, or REGISTRY_INVALID_INDEX if the pointer is not registered
+		static inline u32 FindSlot(T* targetPtr)
+		{
+			if (!targetPtr) return REGISTRY_INVALID_INDEX;
+
+			u32 slotIndex = FindSlot(targetPtr->GetID());
+
+			return slotIndex != REGISTRY_INVALID_INDEX
+				&& runtimeContent[slots[slotIndex].denseIndex] == targetPtr
+				? slotIndex
+				: REGISTRY_INVALID_INDEX;
+		}
+
+		//Returns the slot of this dense position
+		static inline u32 SlotOf(u32 denseIndex)
+		{
+			if constexpr (isHashStorage) return denseIndex;
+			else return denseToSlot[denseIndex];
+		}
+
+		//Pops a slot from the free list or appends a new one.
+		//Hash map storage always appends the slot of the next dense position,
+		//fixed array storage returns REGISTRY_INVALID_INDEX once it is full
+		static inline u32 AllocateSlot()
+		{
+			if constexpr (isHashStorage)
+			{
+				slots.push_back(RegistrySlot{});
+				if constexpr (hasHierarchy) hierarchy.push_back(HierarchyNode{});
+
+				return static_cast<u32>(slots.size() - 1);
+			}
+
+			if (firstFreeSlot != REGISTRY_INVALID_INDEX)
+			{
+				u32 slotIndex = firstFreeSlot;
+				firstFreeSlot = slots[slotIndex].nextFree;
+				slots[slotIndex].nextFree = REGISTRY_INVALID_INDEX;
+
+				return slotIndex;
+			}
+
+			if constexpr (isFixedStorage)
+			{
+				constexpr u32 capacity = Policy::fixedCapacity;
+
+				if (slots.size() >= capacity) return REGISTRY_INVALID_INDEX;
+
+				//everything is reserved once so no container ever reallocates
+				if (slots.capacity() < capacity)
 				{
-					return c && c->GetWindowID() == windowID;
-				}), runtimeContent.end());
-					
-			for (auto it = createdContent.begin(); it != createdContent.end();)
+					createdContent.reserve(capacity);
+					runtimeContent.reserve(capacity);
+					denseToSlot.reserve(capacity);
+					slots.reserve(capacity);
+					idToSlot.reserve(capacity);
+					if constexpr (hasHierarchy) hierarchy.reserve(capacity);
+				}
+			}
+
+			slots.push_back(RegistrySlot{});
+			if constexpr (hasHierarchy) hierarchy.push_back(HierarchyNode{});
+
+			return static_cast<u32>(slots.size() - 1);
+		}
+
+		//Adds the content of this slot to the window and name indexes it qualifies for
+		static inline void IndexContent(u32 slotIndex)
+		{
+			T* content = runtimeContent[slots[slotIndex].denseIndex];
+
+			if constexpr (HasRegistryWindowID<T>)
+			{
+				AddToIndex(windowIndex, content->GetWindowID(), slotIndex, &RegistrySlot::windowPosition);
+			}
+			if constexpr (HasRegistryName<T>)
+			{
+				AddToIndex(nameIndex, content->GetName(), slotIndex, &RegistrySlot::namePosition);
+			}
+		}
+		//Removes the content of this slot from the window and name indexes, content must still be alive
+		static inline void UnindexContent(u32 slotIndex)
+		{
+			T* content = runtimeContent[slots[slotIndex].denseIndex];
+
+			if constexpr (HasRegistryWindowID<T>)
+			{
+				RemoveFromIndex(windowIndex, content->GetWindowID(), slotIndex, &RegistrySlot::windowPosition);
+			}
+			if constexpr (HasRegistryName<T>)
+			{
+				RemoveFromIndex(nameIndex, content->GetName(), slotIndex, &RegistrySlot::namePosition);
+			}
+		}
+
+		//Appends the content of this slot to its bucket and stores its position in the slot
+		template<typename Index, typename Key>
+		static inline void AddToIndex(
+			Index& index,
+			const Key& key,
+			u32 slotIndex,
+			u32 RegistrySlot::* position)
+		{
+			auto it = index.find(key);
+			if (it == index.end()) it = index.emplace(typename Index::key_type(key), vector<T*>{}).first;
+
+			vector<T*>& bucket = it->second;
+			slots[slotIndex].*position = static_cast<u32>(bucket.size());
+			bucket.push_back(runtimeContent[slots[slotIndex].denseIndex]);
+		}
+		//Swap-removes the content of this slot from its bucket, empty buckets are dropped
+		template<typename Index, typename Key>
+		static inline void RemoveFromIndex(
+			Index& index,
+			const Key& key,
+			u32 slotIndex,
+			u32 RegistrySlot::* position)
+		{
+			u32 bucketIndex = slots[slotIndex].*position;
+			if (bucketIndex == REGISTRY_INVALID_INDEX) return;
+
+			auto it = index.find(key);
+			if (it == index.end()) return;
+
+			vector<T*>& bucket = it->second;
+			T* moved = bucket.back();
+			bucket[bucketIndex] = moved;
+			bucket.pop_back();
+
+			if (bucketIndex < bucket.size())
+			{
+				slots[FindSlot(moved)].*position = bucketIndex;
+			}
+			if (bucket.empty()) index.erase(it);
+
+			slots[slotIndex].*position = REGISTRY_INVALID_INDEX;
+		}
+
+		//Hands the flushed batch storage back to pendingRemovals so its capacity is reused
+		static inline void RecycleRemovalBatch(vector<u32>& batch)
+		{
+			if (!pendingRemovals.empty()) return;
+
+			batch.clear();
+			batch.swap(pendingRemovals);
+		}
+
+		//Invalidates the slot and pushes it to the free list
+		static inline void FreeSlot(u32 slotIndex)
+		{
+			RegistrySlot& slot = slots[slotIndex];
+
+			slot.denseIndex = REGISTRY_INVALID_INDEX;
+			slot.ID = 0;
+			slot.isPendingRemoval = false;
+			++slot.generation;
+			slot.nextFree = firstFreeSlot;
+			firstFreeSlot = slotIndex;
+		}
+
+		//Detaches the hierarchy node of this slot from its parent and orphans its direct children,
+		//only the direct neighbours are touched
+		static inline void DetachHierarchy(u32 slotIndex)
+		{
+			HierarchyNode& node = hierarchy[slotIndex];
+
+			if constexpr (isIntrusiveHierarchy)
+			{
+				if (node.parent != REGISTRY_INVALID_INDEX) hierarchy[node.parent].UnlinkChild(slotIndex);
+			}
+			else node.RemoveParent();
+
+			node.RemoveAllChildren();
+			node = HierarchyNode{};
+		}
+
+		//Swap-removes the dense content of this slot and returns the slot to the free list.
+		//The owner is destroyed last so its destructor sees a consistent registry
+		static inline void EraseSlot(u32 slotIndex)
+		{
+			StatScope scope(RegistryStatTarget::STAT_REMOVE);
+
+			UnindexContent(slotIndex);
+			if constexpr (hasHierarchy) DetachHierarchy(slotIndex);
+
+			u32 denseIndex = slots[slotIndex].denseIndex;
+			u32 lastIndex = static_cast<u32>(runtimeContent.size() - 1);
+
+			unique_ptr<T> removed = move(createdContent[denseIndex]);
+			idToSlot.erase(slots[slotIndex].ID);
+
+			if (denseIndex != lastIndex)
+			{
+				createdContent[denseIndex] = move(createdContent[lastIndex]);
+				runtimeContent[denseIndex] = runtimeContent[lastIndex];
+
+				//hash map slots and nodes travel with their content
+				if constexpr (isHashStorage)
+				{
+					slots[denseIndex] = slots[lastIndex];
+					slots[denseIndex].denseIndex = denseIndex;
+					idToSlot[slots[denseIndex].ID] = denseIndex;
+					if constexpr (hasHierarchy) hierarchy[denseIndex] = move(hierarchy[lastIndex]);
+				}
+				else
+				{
+					denseToSlot[denseIndex] = denseToSlot[lastIndex];
+					slots[denseToSlot[denseIndex]].denseIndex = denseIndex;
+				}
+			}
+
+			createdContent.pop_back();
+			runtimeContent.pop_back();
+			if constexpr (isHashStorage)
+			{
+				slots.pop_back();
+				if constexpr (hasHierarchy) hierarchy.pop_back();
+			}
+			else
+			{
+				denseToSlot.pop_back();
+				FreeSlot(slotIndex);
+			}
+
+			isTraversalDirty = true;
+
+			removed.reset();
+		}
+
+		//Flattens every root and its descendants into traversalOrder in pre-order.
+		//Intrusive links are walked without recursion or an explicit stack and subtree sizes are
+		//closed while climbing back up, vector children go through an explicit stack instead
+		static inline void RebuildTraversalOrder()
+			requires hasHierarchy
+		{
+			traversalOrder.clear();
+			traversalOrder.reserve(runtimeContent.size());
+
+			if constexpr (!isIntrusiveHierarchy) RebuildVectorTraversalOrder();
+			else
+			{
+				for (u32 rootSlot : denseToSlot)
+				{
+					if (hierarchy[rootSlot].parent != REGISTRY_INVALID_INDEX) continue;
+
+					u32 current = rootSlot;
+					u32 parentIndex = REGISTRY_INVALID_INDEX;
+					bool isFinished = false;
+
+					while (!isFinished)
+					{
+						KalaGraphicsHierarchy<T>& node = hierarchy[current];
+						node.traversalIndex = static_cast<u32>(traversalOrder.size());
+						traversalOrder.push_back({ node.thisObject, current, parentIndex, 1 });
+
+						//descend first
+						if (node.firstChild != REGISTRY_INVALID_INDEX)
+						{
+							parentIndex = node.traversalIndex;
+							current = node.firstChild;
+							continue;
+						}
+
+						//then climb until a node with a next sibling is found, closing each finished subtree
+						while (true)
+						{
+							KalaGraphicsHierarchy<T>& done = hierarchy[current];
+							traversalOrder[done.traversalIndex].subtreeSize =
+								static_cast<u32>(traversalOrder.size()) - done.traversalIndex;
+
+							if (current == rootSlot)
+							{
+								isFinished = true;
+								break;
+							}
+							if (done.nextSibling != REGISTRY_INVALID_INDEX)
+							{
+								current = done.nextSibling;
+								break;
+							}
+
+							current = done.parent;
+							parentIndex = traversalOrder[hierarchy[current].traversalIndex].parentIndex;
+						}
+					}
+				}
+			}
+
+			isTraversalDirty = false;
+			++traversalRevision;
+		}
+		//Pre-order walk over children vectors, subtree sizes are summed up in a backwards pass afterwards
+		static inline void RebuildVectorTraversalOrder()
+			requires hasHierarchy
+		{
+			//slot and traversal index of the parent
+			vector<array<u32, 2>> pending{};
+
+			for (u32 denseIndex = 0; denseIndex < runtimeContent.size(); ++denseIndex)
+			{
+				u32 rootSlot = SlotOf(denseIndex);
+				if (hierarchy[rootSlot].parent) continue;
+
+				pending.push_back({ rootSlot, REGISTRY_INVALID_INDEX });
+				while (!pending.empty())
+				{
+					auto [current, parentIndex] = pending.back();
+					pending.pop_back();
+
+					HierarchyNode& node = hierarchy[current];
+					node.traversalIndex = static_cast<u32>(traversalOrder.size());
+					traversalOrder.push_back({ node.thisObject, current, parentIndex, 1 });
+
+					//pushed in reverse so the first child is visited first
+					for (size_t i = node.children.size(); i > 0; --i)
+					{
+						pending.push_back({ FindSlot(node.children[i - 1]), node.traversalIndex });
+					}
+				}
+			}
+
+			//every child comes after its parent, so walking backwards adds finished subtrees upwards
+			for (size_t i = traversalOrder.size(); i > 0; --i)
 			{
-				if (it->second->GetWindowID() == windowID)
+				const KalaGraphicsTraversalEntry<T>& entry = traversalOrder[i - 1];
+				if (entry.parentIndex != REGISTRY_INVALID_INDEX)
 				{
-					it = createdContent.erase(it);
+					traversalOrder[entry.parentIndex].subtreeSize += entry.subtreeSize;
 				}
-				else ++it;
 			}
 		}
 	};
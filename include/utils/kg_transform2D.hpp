@@ -5,9 +5,13 @@
 
 #pragma once
 
+#include <vector>
+#include <algorithm>
+
 #include "KalaHeaders/math_utils.hpp"
 
 #include "utils/kg_registry.hpp"
+#include "utils/kg_pool.hpp"
 #include "core/kg_core.hpp"
 
 constexpr f32 MAX_POS = 10000.0f;
@@ -16,10 +20,18 @@ constexpr f32 MIN_POS = -10000.0f;
 constexpr f32 MAX_SIZE = 10000.0f;
 constexpr f32 MIN_SIZE = 0.01f;
 
+namespace KalaGraphics::UI
+{
+	class TweenEngine;
+}
+
 namespace KalaGraphics::Utils
 {
 	using std::unique_ptr;
 	using std::make_unique;
+	using std::vector;
+	using std::sort;
+	using std::span;
 	
 	using KalaHeaders::vec2;
 	using KalaHeaders::vec3;
@@ -29,6 +41,10 @@ namespace KalaGraphics::Utils
 	using KalaHeaders::kclamp;
 	
 	using KalaGraphics::Utils::KalaGraphicsRegistry;
+	using KalaGraphics::Utils::RegistryPolicy;
+	using KalaGraphics::Utils::RegistryStorage;
+	using KalaGraphics::Utils::RegistryHierarchy;
+	using KalaGraphics::Utils::RegistryThreading;
 	using KalaGraphics::Core::KalaGraphicsCore;
 
 	enum class PosTarget
@@ -53,10 +69,18 @@ namespace KalaGraphics::Utils
 		SIZE_COMBINED //final position after combining world and local position
 	};
 
-	class Transform2D
+	class TransformBatch2D;
+
+	class Transform2D : public KalaGraphicsPooled<Transform2D>
 	{
 	public:
-		static inline KalaGraphicsRegistry<Transform2D> registry{};
+		//Transforms are walked in hierarchy order every frame and may be created from worker threads
+		static inline KalaGraphicsRegistry<
+			Transform2D,
+			RegistryPolicy<
+				RegistryStorage::STORAGE_SLOT_MAP,
+				RegistryHierarchy::HIERARCHY_INTRUSIVE,
+				RegistryThreading::THREADING_QUEUED>> registry{};
 
 		static inline Transform2D* Initialize()
 		{
@@ -64,18 +88,103 @@ namespace KalaGraphics::Utils
 			Transform2D* transformPtr = newTransform.get();
 
 			transformPtr->size_world = vec2(1.0f);
+			transformPtr->size_local = vec2(1.0f);
 
-			u32 newID = ++KalaGraphicsCore::globalID;
-			registry.AddContent(newID, move(newTransform));
+			u32 newID = KalaGraphicsCore::GetNewID();
+			transformPtr->ID = newID;
+			transformPtr->MarkDirty();
+			//off the main thread the insert is deferred until FlushQueuedContent
+			if (KalaGraphicsCore::IsMainThread()) registry.AddContent(newID, move(newTransform));
+			else registry.QueueContent(newID, move(newTransform));
 
 			return transformPtr;
 		}
 
+		inline u32 GetID() const { return ID; }
+
+		//Links this transform under the parent transform,
+		//combined values follow the parent from the next update onwards
+		inline bool SetParent(Transform2D* parent) { return registry.GetHierarchy(this).SetParent(parent); }
+		//Unlinks this transform from its parent, combined values fall back to world values
+		inline bool RemoveParent() { return registry.GetHierarchy(this).RemoveParent(); }
+
+		//Called by the registry hierarchy on every parent change, also when the parent is removed
+		//and this transform is orphaned, so direct hierarchy edits never leave stale combined values
+		inline void OnParentChanged() { MarkDirty(); }
+		inline Transform2D* GetParent() { return registry.GetHierarchy(this).GetParent(); }
+
+		//Bumped every time UpdateDirtyTransforms changes any combined value,
+		//caches built from combined values compare against it
+		static inline u64 GetValueRevision() { return valueRevision; }
+
+		//Recomputes combined values of every dirty transform and its descendants in parent-before-child order,
+		//each affected subtree is walked once no matter how many of its transforms changed.
+		//Called lazily by the combined getters, call it once per frame before rendering to keep the cost in one place.
+		//Does nothing if nothing changed since the last update or if called off the main thread
+		static inline void UpdateDirtyTransforms()
+		{
+			if (!KalaGraphicsCore::IsMainThread()) return;
+
+			//transforms created on other threads are dirty from the start but could not be listed yet,
+			//queued content is always appended to the end of the dense content
+			if (registry.HasQueuedContent())
+			{
+				u32 addedCount = registry.FlushQueuedContent();
+				span<Transform2D* const> all = registry.GetAllContent();
+
+				for (size_t i = all.size() - addedCount; i < all.size(); ++i)
+				{
+					if (all[i]->isDirty) dirtyTransforms.push_back(all[i]->ID);
+				}
+			}
+
+			if (dirtyTransforms.empty()) return;
+
+			span<const KalaGraphicsTraversalEntry<Transform2D>> order = registry.GetTraversalOrder();
+
+			//resolve to traversal positions, removed transforms are skipped
+			dirtyStarts.clear();
+			for (u32 id : dirtyTransforms)
+			{
+				Transform2D* t = registry.GetContent(id);
+				if (t
+					&& t->isDirty)
+				{
+					dirtyStarts.push_back(registry.GetHierarchy(t).traversalIndex);
+				}
+			}
+			dirtyTransforms.clear();
+
+			//ancestors come first so nested dirty transforms fall inside an already updated range
+			sort(dirtyStarts.begin(), dirtyStarts.end());
+
+			if (!dirtyStarts.empty()) ++valueRevision;
+
+			u32 updatedEnd{};
+			for (u32 start : dirtyStarts)
+			{
+				if (start < updatedEnd) continue;
+
+				updatedEnd = start + order[start].subtreeSize;
+				RecordUpdatedRange(start, updatedEnd);
+
+				for (u32 i = start; i < updatedEnd; ++i)
+				{
+					const KalaGraphicsTraversalEntry<Transform2D>& entry = order[i];
+
+					entry.object->UpdateTransform(
+						entry.parentIndex != REGISTRY_INVALID_INDEX
+						? order[entry.parentIndex].object
+						: nullptr);
+					entry.object->isDirty = false;
+				}
+			}
+		}
+
 		//Incrementally moves over time
 		inline void AddPos(
 			const vec2 pos_delta,
-			PosTarget posTarget,
-			const Transform2D& parent = Transform2D{})
+			PosTarget posTarget)
 		{
 			//cannot set combined pos
 			if (posTarget == PosTarget::POS_COMBINED) return;
@@ -95,13 +204,12 @@ namespace KalaGraphics::Utils
 			case PosTarget::POS_LOCAL:  pos_local = pos_clamped; break;
 			}
 
-			UpdateTransform(parent);
+			MarkDirty();
 		}
 		//Snaps to given position
 		inline void SetPos(
 			const vec2 pos_new,
-			PosTarget posTarget,
-			const Transform2D& parent = Transform2D{})
+			PosTarget posTarget)
 		{
 			//cannot set combined pos
 			if (posTarget == PosTarget::POS_COMBINED) return;
@@ -117,12 +225,14 @@ namespace KalaGraphics::Utils
 			case PosTarget::POS_LOCAL:  pos_local = pos_clamped; break;
 			}
 
-			UpdateTransform(parent);
+			MarkDirty();
 		}
 		inline const vec2 GetPos(PosTarget posTarget) const
 		{
 			static const vec2 empty{};
 
+			if (posTarget == PosTarget::POS_COMBINED) FlushIfDirty();
+
 			switch (posTarget)
 			{
 			case PosTarget::POS_WORLD:    return pos_world; break;
@@ -136,8 +246,7 @@ namespace KalaGraphics::Utils
 		//Takes in rotation in euler (degrees) and incrementally rotates over time
 		inline void AddRot(
 			float rot_delta,
-			RotTarget rotTarget,
-			const Transform2D& parent = Transform2D{})
+			RotTarget rotTarget)
 		{
 			//cannot set combined vec rot
 			if (rotTarget == RotTarget::ROT_COMBINED) return;
@@ -154,13 +263,12 @@ namespace KalaGraphics::Utils
 			case RotTarget::ROT_LOCAL: rot_local = rot_clamped; break;
 			}
 
-			UpdateTransform(parent);
+			MarkDirty();
 		}
 		//Takes in rotation in euler (degrees) and snaps to given rotation
 		inline void SetRot(
 			const f32 rot_new,
-			RotTarget rotTarget,
-			const Transform2D& parent = Transform2D{})
+			RotTarget rotTarget)
 		{
 			//cannot set combined vec rot
 			if (rotTarget == RotTarget::ROT_COMBINED) return;
@@ -173,13 +281,15 @@ namespace KalaGraphics::Utils
 			case RotTarget::ROT_LOCAL: rot_local = rot_clamped; break;
 			}
 
-			UpdateTransform(parent);
+			MarkDirty();
 		}
 		//Returns rotation in euler (degrees)
 		inline const f32 GetRot(RotTarget rotTarget) const
 		{
 			static const f32 empty{};
 
+			if (rotTarget == RotTarget::ROT_COMBINED) FlushIfDirty();
+
 			switch (rotTarget)
 			{
 			case RotTarget::ROT_WORLD:    return rot_world; break;
@@ -193,8 +303,7 @@ namespace KalaGraphics::Utils
 		//Incrementally scales over time
 		inline void AddSize(
 			const vec2 size_delta,
-			SizeTarget sizeTarget,
-			const Transform2D& parent = Transform2D{})
+			SizeTarget sizeTarget)
 		{
 			//cannot set combined size
 			if (sizeTarget == SizeTarget::SIZE_COMBINED) return;
@@ -214,13 +323,12 @@ namespace KalaGraphics::Utils
 			case SizeTarget::SIZE_LOCAL: size_local = size_clamped; break;
 			}
 
-			UpdateTransform(parent);
+			MarkDirty();
 		}
 		//Snaps to given size
 		inline void SetSize(
 			const vec2 size_new,
-			SizeTarget sizeTarget,
-			const Transform2D& parent = Transform2D{})
+			SizeTarget sizeTarget)
 		{
 			//cannot set combined size
 			if (sizeTarget == SizeTarget::SIZE_COMBINED) return;
@@ -236,12 +344,14 @@ namespace KalaGraphics::Utils
 			case SizeTarget::SIZE_LOCAL: size_local = size_clamped; break;
 			}
 
-			UpdateTransform(parent);
+			MarkDirty();
 		}
 		inline const vec2 GetSize(SizeTarget sizeTarget) const
 		{
 			static const vec2 empty{};
 
+			if (sizeTarget == SizeTarget::SIZE_COMBINED) FlushIfDirty();
+
 			switch (sizeTarget)
 			{
 			case SizeTarget::SIZE_WORLD:      return size_world; break;
@@ -252,15 +362,79 @@ namespace KalaGraphics::Utils
 			return empty;
 		};
 	private:
-		//Updates combined pos, rot and size relative to local and optional parent values
-		inline void UpdateTransform(const Transform2D& parent)
+		friend class TransformBatch2D;
+		//writes tweened values straight into the fields and marks each moved transform dirty once
+		friend class KalaGraphics::UI::TweenEngine;
+
+		//Traversal range whose combined values were recomputed
+		struct UpdatedRange
 		{
-			if (parent.pos_combined != 0.0f)
+			u32 start{};
+			u32 end{};
+		};
+
+		//More ranges than this between two batch solves mean most of the scene moved,
+		//the list is dropped and the next solve rebuilds everything instead
+		static constexpr size_t MAX_UPDATED_RANGES = 256;
+
+		//IDs of transforms whose own values changed since the last UpdateDirtyTransforms call
+		static inline vector<u32> dirtyTransforms{};
+		//Traversal positions of the dirty transforms, kept around so its capacity is reused every frame
+		static inline vector<u32> dirtyStarts{};
+		static inline u64 valueRevision{};
+
+		//Ranges recomputed since TransformBatch2D last consumed them, all of one traversal revision
+		//as long as the batch solved that revision, otherwise the batch rebuilds everything anyway
+		static inline vector<UpdatedRange> updatedRanges{};
+		static inline bool isUpdatedRangeOverflow{};
+
+		static inline void RecordUpdatedRange(
+			u32 start,
+			u32 end)
+		{
+			if (isUpdatedRangeOverflow) return;
+
+			if (updatedRanges.size() == MAX_UPDATED_RANGES)
 			{
-				rot_combined = parent.rot_combined + rot_world + rot_local;
-				size_combined = parent.size_combined * size_world * size_local;
+				updatedRanges.clear();
+				isUpdatedRangeOverflow = true;
+
+				return;
+			}
+
+			updatedRanges.push_back({ start, end });
+		}
 
-				f32 rads = radians(parent.rot_combined);
+		//Lists this transform for the next update, descendants are picked up through the hierarchy.
+		//Transforms still queued from other threads are listed when their queue is flushed
+		inline void MarkDirty()
+		{
+			if (isDirty) return;
+
+			isDirty = true;
+			if (KalaGraphicsCore::IsMainThread()) dirtyTransforms.push_back(ID);
+		}
+
+		//Combined values are only stale while something is listed or queued
+		static inline void FlushIfDirty()
+		{
+			if (!dirtyTransforms.empty()
+				|| registry.HasQueuedContent())
+			{
+				UpdateDirtyTransforms();
+			}
+		}
+
+		//Updates combined pos, rot and size relative to local and optional parent values,
+		//the parent must already be up to date
+		inline void UpdateTransform(const Transform2D* parent)
+		{
+			if (parent)
+			{
+				rot_combined = parent->rot_combined + rot_world + rot_local;
+				size_combined = parent->size_combined * size_world * size_local;
+
+				f32 rads = radians(parent->rot_combined);
 				mat3 rot_mat =
 				{
 					cos(rads), -sin(rads), 0.0f,
@@ -270,7 +444,7 @@ namespace KalaGraphics::Utils
 
 				vec3 rot_offset = vec3(rot_mat * vec3(pos_local, 1.0f));
 				pos_combined =
-					parent.pos_combined
+					parent->pos_combined
 					+ pos_world
 					+ vec2(rot_offset.x, rot_offset.y);
 			}
@@ -282,6 +456,11 @@ namespace KalaGraphics::Utils
 			}
 		}
 
+		u32 ID{};
+
+		//own values changed and this transform is listed for the next update
+		bool isDirty{};
+
 		vec2 pos_world{};
 		vec2 pos_local{};
 		vec2 pos_combined{};
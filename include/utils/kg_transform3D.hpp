@@ -6,10 +6,13 @@
 #pragma once
 
 #include <memory>
+#include <array>
+#include <limits>
 
 #include "KalaHeaders/math_utils.hpp"
 
 #include "utils/kg_registry.hpp"
+#include "utils/kg_pool.hpp"
 #include "core/kg_core.hpp"
 
 constexpr f32 MAX_POS = 10000.0f;
@@ -22,6 +25,8 @@ namespace KalaGraphics::Utils
 {
 	using std::unique_ptr;
 	using std::make_unique;
+	using std::array;
+	using std::numeric_limits;
 	
 	using KalaHeaders::vec3;
 	using KalaHeaders::vec4;
@@ -32,8 +37,13 @@ namespace KalaGraphics::Utils
 	using KalaHeaders::toeuler3;
 	using KalaHeaders::toquat;
 	using KalaHeaders::normalize;
+	using KalaHeaders::cross;
 	
 	using KalaGraphics::Utils::KalaGraphicsRegistry;
+	using KalaGraphics::Utils::RegistryPolicy;
+	using KalaGraphics::Utils::RegistryStorage;
+	using KalaGraphics::Utils::RegistryHierarchy;
+	using KalaGraphics::Utils::RegistryThreading;
 	using KalaGraphics::Core::KalaGraphicsCore;
 
 	enum class PosTarget
@@ -58,10 +68,16 @@ namespace KalaGraphics::Utils
 		SIZE_COMBINED //final position after combining world and local position
 	};
 
-	class Transform3D
+	class Transform3D : public KalaGraphicsPooled<Transform3D>
 	{
 	public:
-		static inline KalaGraphicsRegistry<Transform3D> registry{};
+		//Transforms are walked in hierarchy order every frame and may be created from worker threads
+		static inline KalaGraphicsRegistry<
+			Transform3D,
+			RegistryPolicy<
+				RegistryStorage::STORAGE_SLOT_MAP,
+				RegistryHierarchy::HIERARCHY_INTRUSIVE,
+				RegistryThreading::THREADING_QUEUED>> registry{};
 
 		static inline Transform3D* Initialize()
 		{
@@ -69,18 +85,32 @@ namespace KalaGraphics::Utils
 			Transform3D* transformPtr = newTransform.get();
 
 			transformPtr->size_world = vec3(1.0f);
-
-			u32 newID = ++KalaGraphicsCore::globalID;
-			registry.AddContent(newID, move(newTransform));
+			transformPtr->size_local = vec3(1.0f);
+			transformPtr->rot_world = quat(0.0f, 0.0f, 0.0f, 1.0f);
+			transformPtr->rot_local = quat(0.0f, 0.0f, 0.0f, 1.0f);
+			transformPtr->rot_combined = quat(0.0f, 0.0f, 0.0f, 1.0f);
+			transformPtr->UpdateTransform(nullptr);
+
+			u32 newID = KalaGraphicsCore::GetNewID();
+			transformPtr->ID = newID;
+			//off the main thread the insert is deferred until FlushQueuedContent
+			if (KalaGraphicsCore::IsMainThread()) registry.AddContent(newID, move(newTransform));
+			else registry.QueueContent(newID, move(newTransform));
 
 			return transformPtr;
 		}
 
+		inline u32 GetID() const { return ID; }
+
+		//Links this transform under the parent transform, TransformBatch3D composes it with the parent from then on
+		inline bool SetParent(Transform3D* parent) { return registry.GetHierarchy(this).SetParent(parent); }
+		inline bool RemoveParent() { return registry.GetHierarchy(this).RemoveParent(); }
+		inline Transform3D* GetParent() { return registry.GetHierarchy(this).GetParent(); }
+
 		//Incrementally moves over time
 		inline void AddPos(
 			const vec3& pos_delta,
-			PosTarget posTarget,
-			const Transform3D& parent = Transform3D{})
+			PosTarget posTarget)
 		{
 			//cannot set combined pos
 			if (posTarget == PosTarget::POS_COMBINED) return;
@@ -100,13 +130,13 @@ namespace KalaGraphics::Utils
 			case PosTarget::POS_LOCAL:  pos_local = pos_clamped; break;
 			}
 
-			UpdateTransform(parent);
+			++valueRevision;
+			UpdateTransform(GetParent());
 		}
 		//Snaps to given position
 		inline void SetPos(
 			const vec3& pos_new,
-			PosTarget posTarget,
-			const Transform3D& parent = Transform3D{})
+			PosTarget posTarget)
 		{
 			//cannot set combined pos
 			if (posTarget == PosTarget::POS_COMBINED) return;
@@ -122,7 +152,8 @@ namespace KalaGraphics::Utils
 			case PosTarget::POS_LOCAL:  pos_local = pos_clamped; break;
 			}
 
-			UpdateTransform(parent);
+			++valueRevision;
+			UpdateTransform(GetParent());
 		}
 		inline const vec3& GetPos(PosTarget posTarget) const
 		{
@@ -138,41 +169,40 @@ namespace KalaGraphics::Utils
 			return empty;
 		}
 
-		//Takes in rotation in euler (degrees) and incrementally rotates over time
+		//Takes in rotation in euler (degrees) and incrementally rotates over time.
+		//The delta is applied on top of the current rotation around its own axes,
+		//the current rotation is never converted back to euler so no error builds up
 		inline void AddRot(
 			const vec3& rot_delta,
-			RotTarget rotTarget,
-			const Transform3D& parent = Transform3D{})
+			RotTarget rotTarget)
 		{
 			//cannot set combined vec rot
 			if (rotTarget == RotTarget::ROT_COMBINED) return;
 
-			vec3 current{};
-
-			switch (rotTarget)
-			{
-			case RotTarget::ROT_WORLD: current = toeuler3(rot_world); break;
-			case RotTarget::ROT_LOCAL: current = toeuler3(rot_local); break;
-			}
-
-			vec3 rot_clamped = vec3(
-				wrap(current.x + rot_delta.x),
-				wrap(current.y + rot_delta.y),
-				wrap(current.z + rot_delta.z));
+			AddRot(toquat(rot_delta), rotTarget);
+		}
+		//Takes in rotation in quaternion and incrementally rotates over time,
+		//reuse the same delta every frame to rotate without any trig
+		inline void AddRot(
+			const quat& rot_delta,
+			RotTarget rotTarget)
+		{
+			//cannot set combined vec rot
+			if (rotTarget == RotTarget::ROT_COMBINED) return;
 
 			switch (rotTarget)
 			{
-			case RotTarget::ROT_WORLD: rot_world = toquat(rot_clamped); break;
-			case RotTarget::ROT_LOCAL: rot_local = toquat(rot_clamped); break;
+			case RotTarget::ROT_WORLD: rot_world = QuatNormalize(QuatMul(rot_world, rot_delta)); break;
+			case RotTarget::ROT_LOCAL: rot_local = QuatNormalize(QuatMul(rot_local, rot_delta)); break;
 			}
 
-			UpdateTransform(parent);
+			++valueRevision;
+			UpdateTransform(GetParent());
 		}
 		//Takes in rotation in euler (degrees) and snaps to given rotation
 		inline void SetRot(
 			const vec3& rot_new,
-			RotTarget rotTarget,
-			const Transform3D& parent = Transform3D{})
+			RotTarget rotTarget)
 		{
 			//cannot set combined vec rot
 			if (rotTarget == RotTarget::ROT_COMBINED) return;
@@ -188,13 +218,13 @@ namespace KalaGraphics::Utils
 			case RotTarget::ROT_LOCAL: rot_local = toquat(rot_clamped); break;
 			}
 
-			UpdateTransform(parent);
+			++valueRevision;
+			UpdateTransform(GetParent());
 		}
 		//Takes in rotation in quaternion and snaps to given rotation
 		inline void SetRot(
 			const quat& rot_new,
-			RotTarget rotTarget,
-			const Transform3D& parent = Transform3D{})
+			RotTarget rotTarget)
 		{
 			//cannot set combined vec rot
 			if (rotTarget == RotTarget::ROT_COMBINED) return;
@@ -207,36 +237,44 @@ namespace KalaGraphics::Utils
 			case RotTarget::ROT_LOCAL: rot_local = rot_clamped; break;
 			}
 
-			UpdateTransform(parent);
+			++valueRevision;
+			UpdateTransform(GetParent());
 		}
-		//Returns rotation in euler (degrees)
+		//Returns rotation in euler (degrees), converted once per rotation change and cached
 		inline const vec3& GetRotEuler(RotTarget rotTarget) const
 		{
-			switch (rotTarget)
+			static const vec3 empty{};
+
+			u8 index = static_cast<u8>(rotTarget);
+			if (index > static_cast<u8>(RotTarget::ROT_COMBINED)) return empty;
+
+			if (eulerRevisions[index] != valueRevision)
 			{
-			case RotTarget::ROT_WORLD:    return toeuler3(rot_world); break;
-			case RotTarget::ROT_LOCAL:    return toeuler3(rot_local); break;
-			case RotTarget::ROT_COMBINED: return toeuler3(rot_combined); break;
-			default:                      return{};
+				eulers[index] = toeuler3(GetRotQuat(rotTarget));
+				eulerRevisions[index] = valueRevision;
 			}
+
+			return eulers[index];
 		}
 		//Returns quaternion rotation
 		inline const quat& GetRotQuat(RotTarget rotTarget) const
 		{
+			static const quat empty{};
+
 			switch (rotTarget)
 			{
 			case RotTarget::ROT_WORLD:    return rot_world; break;
 			case RotTarget::ROT_LOCAL:    return rot_local; break;
 			case RotTarget::ROT_COMBINED: return rot_combined; break;
-			default:                      return{};
 			}
+
+			return empty;
 		}
 
 		//Incrementally scales over time
 		inline void AddSize(
 			const vec3& size_delta,
-			SizeTarget sizeTarget,
-			const Transform3D& parent = Transform3D{})
+			SizeTarget sizeTarget)
 		{
 			//cannot set combined size
 			if (sizeTarget == SizeTarget::SIZE_COMBINED) return;
@@ -256,13 +294,13 @@ namespace KalaGraphics::Utils
 			case SizeTarget::SIZE_LOCAL:  size_local = size_clamped; break;
 			}
 
-			UpdateTransform(parent);
+			++valueRevision;
+			UpdateTransform(GetParent());
 		}
 		//Snaps to given scale
 		inline void SetSize(
 			const vec3& size_new,
-			SizeTarget sizeTarget,
-			const Transform3D& parent = Transform3D{})
+			SizeTarget sizeTarget)
 		{
 			//cannot set combined size
 			if (sizeTarget == SizeTarget::SIZE_COMBINED) return;
@@ -278,7 +316,8 @@ namespace KalaGraphics::Utils
 			case SizeTarget::SIZE_LOCAL: size_local = size_clamped; break;
 			}
 
-			UpdateTransform(parent);
+			++valueRevision;
+			UpdateTransform(GetParent());
 		}
 		inline const vec3& GetSize(SizeTarget sizeTarget) const
 		{
@@ -293,57 +332,147 @@ namespace KalaGraphics::Utils
 
 			return empty;
 		};
+
+		//Returns the model matrix built from combined pos, rot and size,
+		//only rebuilt after one of them changed since the last call
+		inline const mat4& GetWorldMatrix() const
+		{
+			if (worldMatrixRevision != valueRevision)
+			{
+				BuildWorldMatrix();
+				worldMatrixRevision = valueRevision;
+			}
+
+			return worldMatrix;
+		}
+
+		//Bumped every time any pos, rot or size value of this transform changes
+		inline u64 GetValueRevision() const { return valueRevision; }
 	private:
-		//Updates combined pos, rot and size relative to local and optional parent values
-		inline void UpdateTransform(const Transform3D& parent)
+		friend class TransformBatch3D;
+
+		//Updates combined pos, rot and size relative to local and optional parent values.
+		//Only this transform is refreshed, TransformBatch3D refreshes whole hierarchies
+		inline void UpdateTransform(const Transform3D* parent)
 		{
-			if (parent.pos_combined != 0.0f)
+			vec3 pos_new{};
+			quat rot_new{};
+			vec3 size_new{};
+
+			if (parent)
 			{
-				rot_combined = parent.rot_combined * rot_world * rot_local;
-				size_combined = parent.size_combined * size_world * size_local;
-
-				auto rotate = [](const mat4& m, const quat& q)
-					{
-						const f32 xx = q.x * q.x;
-						const f32 yy = q.y * q.y;
-						const f32 zz = q.z * q.z;
-						const f32 xy = q.x * q.y;
-						const f32 xz = q.x * q.z;
-						const f32 yz = q.y * q.z;
-						const f32 wx = q.w * q.x;
-						const f32 wy = q.w * q.y;
-						const f32 wz = q.w * q.z;
-
-						mat4 r =
-						{
-							1 - 2 * (yy + zz), 2 * (xy + wz),     2 * (xz - wy),     0.0f,
-							2 * (xy - wz),     1 - 2 * (xx + zz), 2 * (yz + wx),     0.0f,
-							2 * (xz + wy),     2 * (yz - wx),     1 - 2 * (xx + yy), 0.0f,
-							0.0f,              0.0f,              0.0f,              1.0f
-						};
-
-						return r * m;
-					};
-
-				mat4 rot_mat = rotate(mat4(1.0f), parent.rot_combined);
-
-				vec4 rot_offset = rot_mat * vec4(pos_local, 1.0f);
-				pos_combined =
-					parent.pos_combined
+				rot_new = QuatNormalize(QuatMul(
+					parent->rot_combined,
+					QuatMul(rot_world, rot_local)));
+				size_new = parent->size_combined * size_world * size_local;
+				pos_new =
+					parent->pos_combined
 					+ pos_world
-					+ vec3(
-						rot_offset.x,
-						rot_offset.y,
-						rot_offset.z);
+					+ QuatRotate(parent->rot_combined, pos_local);
 			}
 			else
 			{
-				pos_combined = pos_world;
-				rot_combined = rot_world;
-				size_combined = size_world;
+				pos_new = pos_world;
+				rot_new = QuatNormalize(rot_world);
+				size_new = size_world;
+			}
+
+			//exact compare, an epsilon would let slow movement drift away from the cached matrix
+			if (pos_new.x == pos_combined.x
+				&& pos_new.y == pos_combined.y
+				&& pos_new.z == pos_combined.z
+				&& rot_new.x == rot_combined.x
+				&& rot_new.y == rot_combined.y
+				&& rot_new.z == rot_combined.z
+				&& rot_new.w == rot_combined.w
+				&& size_new.x == size_combined.x
+				&& size_new.y == size_combined.y
+				&& size_new.z == size_combined.z)
+			{
+				return;
 			}
+
+			pos_combined = pos_new;
+			rot_combined = rot_new;
+			size_combined = size_new;
+
+			++valueRevision;
+		}
+
+		//Rotation columns scaled by size, translation in the last column, same layout as createumodel
+		inline void BuildWorldMatrix() const
+		{
+			const quat& q = rot_combined;
+			const vec3& s = size_combined;
+			const vec3& p = pos_combined;
+
+			f32 xx = q.x * q.x;
+			f32 yy = q.y * q.y;
+			f32 zz = q.z * q.z;
+			f32 xy = q.x * q.y;
+			f32 xz = q.x * q.z;
+			f32 yz = q.y * q.z;
+			f32 wx = q.w * q.x;
+			f32 wy = q.w * q.y;
+			f32 wz = q.w * q.z;
+
+			mat4& m = worldMatrix;
+
+			m.m00 = (1.0f - 2.0f * (yy + zz)) * s.x;
+			m.m10 = (2.0f * (xy - wz)) * s.x;
+			m.m20 = (2.0f * (xz + wy)) * s.x;
+			m.m30 = 0.0f;
+
+			m.m01 = (2.0f * (xy + wz)) * s.y;
+			m.m11 = (1.0f - 2.0f * (xx + zz)) * s.y;
+			m.m21 = (2.0f * (yz - wx)) * s.y;
+			m.m31 = 0.0f;
+
+			m.m02 = (2.0f * (xz - wy)) * s.z;
+			m.m12 = (2.0f * (yz + wx)) * s.z;
+			m.m22 = (1.0f - 2.0f * (xx + yy)) * s.z;
+			m.m32 = 0.0f;
+
+			m.m03 = p.x;
+			m.m13 = p.y;
+			m.m23 = p.z;
+			m.m33 = 1.0f;
+		}
+
+		//Hamilton product, applies b first and a second
+		static inline quat QuatMul(
+			const quat& a,
+			const quat& b)
+		{
+			return quat(
+				a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+				a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+				a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+				a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+		}
+		//Rotates v by the unit quaternion q
+		static inline vec3 QuatRotate(
+			const quat& q,
+			const vec3& v)
+		{
+			vec3 u(q.x, q.y, q.z);
+			vec3 t = cross(u, v) * 2.0f;
+
+			return v + t * q.w + cross(u, t);
+		}
+		//Normalizes q, zero-length quaternions become identity
+		static inline quat QuatNormalize(const quat& q)
+		{
+			f32 lengthSq = q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w;
+			if (lengthSq <= 0.0f) return quat(0.0f, 0.0f, 0.0f, 1.0f);
+
+			f32 inv = 1.0f / sqrt(lengthSq);
+
+			return quat(q.x * inv, q.y * inv, q.z * inv, q.w * inv);
 		}
 
+		u32 ID{};
+
 		vec3 pos_world{};
 		vec3 pos_local{};
 		vec3 pos_combined{};
@@ -355,5 +484,18 @@ namespace KalaGraphics::Utils
 		vec3 size_world{};
 		vec3 size_local{};
 		vec3 size_combined{};
+
+		u64 valueRevision{};
+
+		//Caches rebuilt on demand, a revision that never matches valueRevision forces the first build
+		mutable mat4 worldMatrix{};
+		mutable u64 worldMatrixRevision = numeric_limits<u64>::max();
+		mutable array<vec3, 3> eulers{};
+		mutable array<u64, 3> eulerRevisions
+		{
+			numeric_limits<u64>::max(),
+			numeric_limits<u64>::max(),
+			numeric_limits<u64>::max()
+		};
 	};
 }
\ No newline at end of file
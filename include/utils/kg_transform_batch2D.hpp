@@ -0,0 +1,90 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <limits>
+
+#include "KalaHeaders/math_utils.hpp"
+
+#include "utils/kg_transform2D.hpp"
+
+namespace KalaGraphics::Utils
+{
+	using std::vector;
+	using std::span;
+	using std::numeric_limits;
+
+	using KalaHeaders::mat4;
+
+	enum class SimdLevel
+	{
+		SIMD_SCALAR, //one createumodel call per transform
+		SIMD_SSE2,   //four model matrices per kernel step
+		SIMD_AVX     //eight model matrices per kernel step
+	};
+
+	//Builds the model matrices of all Transform2D instances in one pass.
+	//Combined pos, rot and size are kept in persistent structure-of-arrays buffers in parent-before-child
+	//traversal order and turned into a contiguous mat4 array by the widest kernel this CPU supports.
+	//Only the traversal ranges recomputed by Transform2D::UpdateDirtyTransforms since the last solve
+	//are gathered and rebuilt, everything is rebuilt only after the hierarchy changed
+	class LIB_API TransformBatch2D
+	{
+	public:
+		//Returns the widest instruction set supported by both this CPU and the OS, detected once
+		static SimdLevel GetSupportedSimdLevel();
+		//Times every supported kernel on a small batch and returns the fastest one.
+		//Wider is not always faster, some CPUs clock down or split 256-bit work
+		static SimdLevel PickFastestSimdLevel();
+
+		//Picks the kernel used by the next solve, levels above the supported level are clamped down.
+		//Useful for comparing kernels against each other, the fastest level is picked on first use otherwise
+		static void SetSimdLevel(SimdLevel newLevel);
+		static inline SimdLevel GetSimdLevel() { return simdLevel; }
+
+		//Rebuilds the model matrices of every transform whose combined values changed since the last solve,
+		//the returned view is indexed by traversal position and invalidated by the next solve
+		static span<const mat4> Solve();
+
+		//Returns the model matrix of this transform, solves first only if anything changed.
+		//Transforms not registered yet fall back to a single scalar createumodel call
+		static mat4 GetModel(Transform2D* transform);
+
+		//Builds count model matrices from structure-of-arrays input with the active kernel.
+		//Rotations are in degrees, same as createumodel
+		static void BuildModels(
+			const f32* posX,
+			const f32* posY,
+			const f32* rot,
+			const f32* sizeX,
+			const f32* sizeY,
+			mat4* out,
+			size_t count);
+	private:
+		static inline SimdLevel simdLevel = SimdLevel::SIMD_SCALAR;
+		static inline bool isSimdLevelPicked{};
+
+		static inline vector<f32> batchPosX{};
+		static inline vector<f32> batchPosY{};
+		static inline vector<f32> batchRot{};
+		static inline vector<f32> batchSizeX{};
+		static inline vector<f32> batchSizeY{};
+
+		static inline vector<mat4> models{};
+
+		static inline u64 solvedTraversalRevision = numeric_limits<u64>::max();
+
+		//True if a transform is dirty or queued, a range was recomputed or the hierarchy changed since the last solve
+		static bool NeedsSolve();
+		//Copies combined values of this traversal range into the batch buffers and rebuilds its models
+		static void SolveRange(
+			span<const KalaGraphicsTraversalEntry<Transform2D>> order,
+			u32 start,
+			u32 end);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include "KalaHeaders/math_utils.hpp"
+
+#include "utils/kg_transform3D.hpp"
+
+namespace KalaGraphics::Utils
+{
+	using std::vector;
+	using std::span;
+	using std::thread;
+	using std::atomic;
+	using std::mutex;
+	using std::condition_variable;
+
+	using KalaHeaders::mat4;
+
+	//World matrix padded to its own cache line so neighbouring workers never write the same line
+	struct alignas(64) LIB_API WorldMatrix3D
+	{
+		mat4 world{};
+	};
+
+	//Composes every Transform3D with its parents into combined values and world matrices.
+	//The cached pre-order traversal is split into independent subtrees: ancestors of subtrees
+	//too large for one task are solved first on the calling thread, then the subtrees are handed
+	//out to worker threads through an atomic counter. Each worker only writes its own contiguous
+	//range of world matrices and its own transforms. Workers are started once by the first parallel
+	//solve and sleep on a condition variable between solves
+	class LIB_API TransformBatch3D
+	{
+	public:
+		//Solves all transforms, threadCount 0 uses every hardware thread and 1 stays on the calling thread.
+		//Must be called from the main thread, queued transforms are flushed first.
+		//Small scenes are always solved on the calling thread.
+		//The returned view is indexed by traversal position and invalidated by the next solve
+		static span<const WorldMatrix3D> Solve(u32 threadCount = 0);
+
+		//Returns the world matrix of this transform from the last solve,
+		//solves again first if transforms were added or relinked since then
+		static const mat4& GetWorld(Transform3D* transform);
+
+		//Stops and joins the worker threads, the next parallel solve starts them again.
+		//Runs automatically before static destruction
+		static void Shutdown();
+
+		static inline span<const WorldMatrix3D> GetWorldMatrices() { return worlds; }
+	private:
+		//Contiguous traversal range of one or more whole subtrees
+		struct SolveTask
+		{
+			u32 start{};
+			u32 end{};
+		};
+
+		static inline vector<WorldMatrix3D> worlds{};
+		//Ancestors of subtrees too large for a single task, solved before any worker starts
+		static inline vector<u32> spine{};
+		static inline vector<SolveTask> tasks{};
+
+		static inline u64 solvedTraversalRevision{};
+
+		//Persistent workers, the calling thread of each solve is the extra worker
+		static inline vector<thread> workers{};
+		static inline mutex poolMutex{};
+		static inline condition_variable poolWake{};
+		static inline condition_variable poolDone{};
+		//bumped once per parallel solve, a worker wakes up when it differs from the last one it saw
+		static inline u64 solveGeneration{};
+		//workers below this index take part in the current solve
+		static inline u32 activeWorkerCount{};
+		static inline u32 busyWorkerCount{};
+		static inline bool isPoolStopping{};
+
+		static inline atomic<u32> nextTask{};
+		static inline span<const KalaGraphicsTraversalEntry<Transform3D>> solveOrder{};
+
+		static void WorkerLoop(u32 workerIndex);
+		//Solves tasks until the shared counter runs out
+		static void RunTasks();
+
+		//Composes one transform with its already solved parent and writes its world matrix
+		static void SolveNode(
+			span<const KalaGraphicsTraversalEntry<Transform3D>> order,
+			u32 index);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,208 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <algorithm>
+#include <unordered_map>
+
+#include "KalaHeaders/core_utils.hpp"
+
+namespace KalaGraphics::Utils
+{
+	using std::vector;
+	using std::array;
+	using std::atomic;
+	using std::numeric_limits;
+	using std::unordered_map;
+	using std::clamp;
+	using std::copy;
+	using std::memory_order_relaxed;
+	using std::memory_order_acq_rel;
+
+	//Lock-free hand-off of transform state from the update thread to the render thread.
+	//The update thread publishes the combined values of every transform once per simulation tick,
+	//each published snapshot holds both the previous and the current tick so the render thread can
+	//interpolate between them at any alpha. Three snapshots rotate through an atomic index:
+	//one written by the update thread, one waiting, one read by the render thread, so neither
+	//side ever waits on the other or sees a half-written snapshot.
+	//Traits supplies the State type and the Prepare, Capture and Interpolate functions
+	template<typename T, typename Traits>
+	class KalaGraphicsTransformBuffer
+	{
+	public:
+		using State = typename Traits::State;
+
+		//Captures the combined values of every registered transform and publishes them.
+		//Call from the update thread once per simulation tick, after all transforms were updated.
+		//The update thread must be the thread that owns the transform registry
+		static inline void Publish()
+		{
+			Traits::Prepare();
+
+			auto order = T::registry.GetTraversalOrder();
+			u32 count = static_cast<u32>(order.size());
+
+			//the layout only changes when transforms are added, removed or relinked
+			bool isSameLayout =
+				hasPublished
+				&& publishedTraversalRevision == T::registry.traversalRevision
+				&& lastIDs.size() == count;
+
+			if (!isSameLayout)
+			{
+				previousIndexByID.swap(indexByID);
+
+				indexByID.clear();
+				indexByID.reserve(count);
+				lastIDs.resize(count);
+
+				for (u32 i = 0; i < count; ++i)
+				{
+					u32 id = order[i].object->GetID();
+					lastIDs[i] = id;
+					indexByID[id] = i;
+				}
+
+				++layoutRevision;
+				publishedTraversalRevision = T::registry.traversalRevision;
+			}
+
+			Snapshot& snapshot = snapshots[writeIndex];
+			snapshot.previous.resize(count);
+			snapshot.current.resize(count);
+
+			for (u32 i = 0; i < count; ++i) snapshot.current[i] = Traits::Capture(order[i].object);
+
+			if (!hasPublished)
+			{
+				//nothing to interpolate from on the first tick
+				copy(snapshot.current.begin(), snapshot.current.end(), snapshot.previous.begin());
+			}
+			else if (isSameLayout)
+			{
+				copy(lastStates.begin(), lastStates.end(), snapshot.previous.begin());
+			}
+			else
+			{
+				//transforms new in this tick start from their current state
+				for (u32 i = 0; i < count; ++i)
+				{
+					auto it = previousIndexByID.find(lastIDs[i]);
+					snapshot.previous[i] = it != previousIndexByID.end()
+						? lastStates[it->second]
+						: snapshot.current[i];
+				}
+			}
+
+			lastStates.assign(snapshot.current.begin(), snapshot.current.end());
+
+			//the lookup table is only copied into a snapshot after the layout changed
+			if (snapshot.layoutRevision != layoutRevision)
+			{
+				snapshot.indexByID = indexByID;
+				snapshot.layoutRevision = layoutRevision;
+			}
+
+			snapshot.tick = ++tick;
+			hasPublished = true;
+
+			u8 oldReady = readyIndex.exchange(
+				static_cast<u8>(writeIndex | FRESH_BIT),
+				memory_order_acq_rel);
+			writeIndex = oldReady & INDEX_MASK;
+		}
+
+		//Picks up the newest published snapshot, returns false if nothing new was published.
+		//Call from the render thread once per frame before reading any state
+		static inline bool Acquire()
+		{
+			if (!(readyIndex.load(memory_order_relaxed) & FRESH_BIT)) return false;
+
+			u8 oldReady = readyIndex.exchange(readIndex, memory_order_acq_rel);
+			readIndex = oldReady & INDEX_MASK;
+
+			return true;
+		}
+
+		//Returns the state of this transform between the previous and the current tick of the acquired snapshot,
+		//alpha 0 is the previous tick and 1 is the current tick. Returns false if the transform was not published
+		static inline bool GetInterpolated(
+			u32 targetID,
+			f32 alpha,
+			State& outState)
+		{
+			const Snapshot& snapshot = snapshots[readIndex];
+
+			auto it = snapshot.indexByID.find(targetID);
+			if (it == snapshot.indexByID.end()) return false;
+
+			outState = Traits::Interpolate(
+				snapshot.previous[it->second],
+				snapshot.current[it->second],
+				clamp(alpha, 0.0f, 1.0f));
+
+			return true;
+		}
+
+		//Interpolates every transform of the acquired snapshot in publish order
+		static inline void GetAllInterpolated(
+			f32 alpha,
+			vector<State>& outStates)
+		{
+			const Snapshot& snapshot = snapshots[readIndex];
+			f32 clampedAlpha = clamp(alpha, 0.0f, 1.0f);
+
+			outStates.resize(snapshot.current.size());
+			for (size_t i = 0; i < outStates.size(); ++i)
+			{
+				outStates[i] = Traits::Interpolate(
+					snapshot.previous[i],
+					snapshot.current[i],
+					clampedAlpha);
+			}
+		}
+
+		//Simulation tick of the acquired snapshot, 0 if nothing was acquired yet
+		static inline u64 GetAcquiredTick() { return snapshots[readIndex].tick; }
+	private:
+		struct Snapshot
+		{
+			vector<State> previous{};
+			vector<State> current{};
+			unordered_map<u32, u32> indexByID{};
+
+			u64 layoutRevision = numeric_limits<u64>::max();
+			u64 tick{};
+		};
+
+		static constexpr u8 INDEX_MASK = 0b011;
+		static constexpr u8 FRESH_BIT = 0b100;
+
+		static inline array<Snapshot, 3> snapshots{};
+
+		//owned by the update thread
+		static inline u8 writeIndex = 0;
+		//owned by nobody, exchanged by both threads, FRESH_BIT is set until the render thread picks it up
+		static inline atomic<u8> readyIndex{ 1 };
+		//owned by the render thread
+		static inline u8 readIndex = 2;
+
+		//update thread state of the last published tick
+		static inline vector<State> lastStates{};
+		static inline vector<u32> lastIDs{};
+		static inline unordered_map<u32, u32> indexByID{};
+		static inline unordered_map<u32, u32> previousIndexByID{};
+
+		static inline u64 layoutRevision{};
+		static inline u64 publishedTraversalRevision{};
+		static inline u64 tick{};
+		static inline bool hasPublished{};
+	};
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include "KalaHeaders/math_utils.hpp"
+
+#include "utils/kg_transform2D.hpp"
+#include "utils/kg_transform_buffer.hpp"
+
+namespace KalaGraphics::Utils
+{
+	using KalaHeaders::vec2;
+	using KalaHeaders::lerp;
+	using KalaHeaders::wrap;
+
+	//Combined values of one Transform2D at one simulation tick
+	struct LIB_API TransformState2D
+	{
+		vec2 pos{};
+		f32 rot{};      //degrees
+		vec2 size{ 1.0f };
+	};
+
+	struct LIB_API TransformBufferTraits2D
+	{
+		using State = TransformState2D;
+
+		//Combined values are refreshed once for the whole hierarchy before capturing
+		static inline void Prepare() { Transform2D::UpdateDirtyTransforms(); }
+
+		static inline State Capture(Transform2D* transform)
+		{
+			return State
+			{
+				transform->GetPos(PosTarget::POS_COMBINED),
+				transform->GetRot(RotTarget::ROT_COMBINED),
+				transform->GetSize(SizeTarget::SIZE_COMBINED)
+			};
+		}
+
+		//Rotation takes the shorter way around so 350 to 10 degrees turns through 0
+		static inline State Interpolate(
+			const State& a,
+			const State& b,
+			f32 alpha)
+		{
+			f32 rotDelta = b.rot - a.rot;
+			if (rotDelta > 180.0f) rotDelta -= 360.0f;
+			else if (rotDelta < -180.0f) rotDelta += 360.0f;
+
+			return State
+			{
+				lerp(a.pos, b.pos, alpha),
+				wrap(a.rot + rotDelta * alpha),
+				lerp(a.size, b.size, alpha)
+			};
+		}
+	};
+
+	//Publish from the update thread after moving Transform2D instances,
+	//Acquire and read interpolated states from the render thread
+	using TransformBuffer2D = KalaGraphicsTransformBuffer<Transform2D, TransformBufferTraits2D>;
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include "KalaHeaders/math_utils.hpp"
+
+#include "utils/kg_transform3D.hpp"
+#include "utils/kg_transform_buffer.hpp"
+
+namespace KalaGraphics::Utils
+{
+	using KalaHeaders::vec3;
+	using KalaHeaders::quat;
+	using KalaHeaders::lerp;
+	using KalaHeaders::slerp;
+
+	//Combined values of one Transform3D at one simulation tick
+	struct LIB_API TransformState3D
+	{
+		vec3 pos{};
+		quat rot{ 0.0f, 0.0f, 0.0f, 1.0f };
+		vec3 size{ 1.0f };
+	};
+
+	struct LIB_API TransformBufferTraits3D
+	{
+		using State = TransformState3D;
+
+		//Combined values come from the last TransformBatch3D::Solve, only queued transforms are added here
+		static inline void Prepare()
+		{
+			if (Transform3D::registry.HasQueuedContent()) Transform3D::registry.FlushQueuedContent();
+		}
+
+		static inline State Capture(Transform3D* transform)
+		{
+			return State
+			{
+				transform->GetPos(PosTarget::POS_COMBINED),
+				transform->GetRotQuat(RotTarget::ROT_COMBINED),
+				transform->GetSize(SizeTarget::SIZE_COMBINED)
+			};
+		}
+
+		static inline State Interpolate(
+			const State& a,
+			const State& b,
+			f32 alpha)
+		{
+			return State
+			{
+				lerp(a.pos, b.pos, alpha),
+				slerp(a.rot, b.rot, alpha),
+				lerp(a.size, b.size, alpha)
+			};
+		}
+	};
+
+	//Publish from the update thread after TransformBatch3D::Solve,
+	//Acquire and read interpolated states from the render thread
+	using TransformBuffer3D = KalaGraphicsTransformBuffer<Transform3D, TransformBufferTraits3D>;
+}
\ No newline at end of file
@@ -4,6 +4,8 @@
 //Read LICENSE.md for more information.
 
 #include <memory>
+#include <bit>
+#include <immintrin.h>
 
 #include "KalaHeaders/log_utils.hpp"
 
@@ -18,9 +20,139 @@ using KalaGraphics::Core::KalaGraphicsCore;
 using std::to_string;
 using std::unique_ptr;
 using std::make_unique;
+using std::popcount;
 
 namespace KalaGraphics::Graphics
 {
+	static_assert(sizeof(mat4) == sizeof(f32) * 16, "Camera matrices are read as 16 packed floats!");
+	static_assert(sizeof(BoundingBox) == sizeof(f32) * 6, "Culling loads four boxes as six packed vectors!");
+	static_assert(sizeof(BoundingSphere) == sizeof(f32) * 4, "Culling loads each sphere as one packed vector!");
+	static_assert(sizeof(CameraBlock) == 432, "CameraBlock must match the std140 layout of the shader block!");
+
+	//Column-major product a * b, mRC is row R and column C like lookat and createumodel
+	static mat4 MultiplyMatrices(
+		const mat4& a,
+		const mat4& b)
+	{
+		const f32* A = reinterpret_cast<const f32*>(&a);
+		const f32* B = reinterpret_cast<const f32*>(&b);
+
+		mat4 result{};
+		f32* R = reinterpret_cast<f32*>(&result);
+
+		for (u32 c = 0; c < 4; ++c)
+		{
+			for (u32 r = 0; r < 4; ++r)
+			{
+				R[c * 4 + r] =
+					A[0 * 4 + r] * B[c * 4 + 0]
+					+ A[1 * 4 + r] * B[c * 4 + 1]
+					+ A[2 * 4 + r] * B[c * 4 + 2]
+					+ A[3 * 4 + r] * B[c * 4 + 3];
+			}
+		}
+
+		return result;
+	}
+
+	//Frustum planes split into one broadcast register per component, absolute normals are used for box extents
+	struct CullPlanes
+	{
+		__m128 nx[6];
+		__m128 ny[6];
+		__m128 nz[6];
+		__m128 w[6];
+		__m128 ax[6];
+		__m128 ay[6];
+		__m128 az[6];
+	};
+
+	static CullPlanes LoadCullPlanes(const array<vec4, 6>& planes)
+	{
+		CullPlanes result{};
+
+		for (u32 p = 0; p < 6; ++p)
+		{
+			result.nx[p] = _mm_set1_ps(planes[p].x);
+			result.ny[p] = _mm_set1_ps(planes[p].y);
+			result.nz[p] = _mm_set1_ps(planes[p].z);
+			result.w[p] = _mm_set1_ps(planes[p].w);
+			result.ax[p] = _mm_set1_ps(abs(planes[p].x));
+			result.ay[p] = _mm_set1_ps(abs(planes[p].y));
+			result.az[p] = _mm_set1_ps(abs(planes[p].z));
+		}
+
+		return result;
+	}
+
+	//Lane mask of the four spheres or boxes that are not fully behind any plane,
+	//radius is the sphere radius or the box extent projected onto each plane normal
+	static inline __m128 TestPlanes(
+		const CullPlanes& planes,
+		__m128 cx,
+		__m128 cy,
+		__m128 cz,
+		__m128 ex,
+		__m128 ey,
+		__m128 ez,
+		bool isSphere)
+	{
+		__m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		__m128 zero = _mm_setzero_ps();
+
+		for (u32 p = 0; p < 6; ++p)
+		{
+			__m128 d = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(planes.nx[p], cx), _mm_mul_ps(planes.ny[p], cy)),
+				_mm_add_ps(_mm_mul_ps(planes.nz[p], cz), planes.w[p]));
+
+			__m128 r = isSphere
+				? ex
+				: _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(planes.ax[p], ex), _mm_mul_ps(planes.ay[p], ey)),
+					_mm_mul_ps(planes.az[p], ez));
+
+			visible = _mm_and_ps(visible, _mm_cmpge_ps(_mm_add_ps(d, r), zero));
+		}
+
+		return visible;
+	}
+
+	static inline bool IsBoxVisible(
+		const array<vec4, 6>& planes,
+		const BoundingBox& box)
+	{
+		vec3 c = (box.min + box.max) * 0.5f;
+		vec3 e = (box.max - box.min) * 0.5f;
+
+		for (const vec4& p : planes)
+		{
+			f32 d = p.x * c.x + p.y * c.y + p.z * c.z + p.w;
+			f32 r = abs(p.x) * e.x + abs(p.y) * e.y + abs(p.z) * e.z;
+
+			if (d + r < 0.0f) return false;
+		}
+
+		return true;
+	}
+	static inline bool IsSphereVisible(
+		const array<vec4, 6>& planes,
+		const BoundingSphere& sphere)
+	{
+		for (const vec4& p : planes)
+		{
+			f32 d =
+				p.x * sphere.center.x
+				+ p.y * sphere.center.y
+				+ p.z * sphere.center.z
+				+ p.w;
+
+			if (d + sphere.radius < 0.0f) return false;
+		}
+
+		return true;
+	}
+
 	Camera* Camera::Initialize(
 		const string& cameraName,
 		vec2 framebufferSize,
@@ -29,7 +161,7 @@ namespace KalaGraphics::Graphics
 		const vec3& pos,
 		const vec3& rot)
 	{
-		u32 newID = ++KalaGraphicsCore::globalID;
+		u32 newID = KalaGraphicsCore::GetNewID();
 		unique_ptr<Camera> newCam = make_unique<Camera>();
 		Camera* camPtr = newCam.get();
 
@@ -48,11 +180,12 @@ namespace KalaGraphics::Graphics
 		f32 aspectRatio = framebufferSize.x / framebufferSize.y;
 		camPtr->SetAspectRatio(aspectRatio);
 
-		registry.AddContent(newID, move(newCam));
-
+		//name and ID are assigned before registering so the name index files the camera under its real name
 		camPtr->name = cameraName;
 		camPtr->ID = newID;
 
+		registry.AddContent(newID, move(newCam));
+
 		camPtr->isInitialized = true;
 
 		Log::Print(
@@ -70,4 +203,243 @@ namespace KalaGraphics::Graphics
 			"CAMERA",
 			LogType::LOG_INFO);
 	}
+
+	size_t Camera::CullBoxes(
+		span<const BoundingBox> boxes,
+		vector<u64>& outVisible) const
+	{
+		const array<vec4, 6>& planes = GetFrustumPlanes();
+		CullPlanes simdPlanes = LoadCullPlanes(planes);
+
+		size_t count = boxes.size();
+		outVisible.assign((count + 63) / 64, 0);
+
+		const f32* data = reinterpret_cast<const f32*>(boxes.data());
+		__m128 half = _mm_set1_ps(0.5f);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			//four boxes are six vectors: min0 max0 | min1 max1 | min2 max2 | min3 max3
+			const f32* b = data + i * 6;
+			__m128 l0 = _mm_loadu_ps(b);
+			__m128 l1 = _mm_loadu_ps(b + 4);
+			__m128 l2 = _mm_loadu_ps(b + 8);
+			__m128 l3 = _mm_loadu_ps(b + 12);
+			__m128 l4 = _mm_loadu_ps(b + 16);
+			__m128 l5 = _mm_loadu_ps(b + 20);
+
+			//mins end up in lanes 0-2, maxes in lanes 1-3
+			__m128 min0 = l0;
+			__m128 min1 = _mm_shuffle_ps(l1, l2, _MM_SHUFFLE(0, 0, 3, 2));
+			__m128 min2 = l3;
+			__m128 min3 = _mm_shuffle_ps(l4, l5, _MM_SHUFFLE(0, 0, 3, 2));
+			_MM_TRANSPOSE4_PS(min0, min1, min2, min3);
+
+			__m128 max0 = _mm_shuffle_ps(l0, l1, _MM_SHUFFLE(1, 0, 3, 3));
+			__m128 max1 = l2;
+			__m128 max2 = _mm_shuffle_ps(l3, l4, _MM_SHUFFLE(1, 0, 3, 3));
+			__m128 max3 = l5;
+			_MM_TRANSPOSE4_PS(max0, max1, max2, max3);
+
+			//after the transposes min0-2 hold min xyz and max1-3 hold max xyz of all four boxes
+			__m128 cx = _mm_mul_ps(_mm_add_ps(min0, max1), half);
+			__m128 cy = _mm_mul_ps(_mm_add_ps(min1, max2), half);
+			__m128 cz = _mm_mul_ps(_mm_add_ps(min2, max3), half);
+			__m128 ex = _mm_mul_ps(_mm_sub_ps(max1, min0), half);
+			__m128 ey = _mm_mul_ps(_mm_sub_ps(max2, min1), half);
+			__m128 ez = _mm_mul_ps(_mm_sub_ps(max3, min2), half);
+
+			u64 bits = static_cast<u64>(_mm_movemask_ps(TestPlanes(
+				simdPlanes,
+				cx, cy, cz,
+				ex, ey, ez,
+				false)));
+
+			//i is a multiple of four so the four bits never cross a word
+			outVisible[i >> 6] |= bits << (i & 63);
+		}
+		for (; i < count; ++i)
+		{
+			if (IsBoxVisible(planes, boxes[i])) outVisible[i >> 6] |= 1ull << (i & 63);
+		}
+
+		size_t visibleCount{};
+		for (u64 word : outVisible) visibleCount += static_cast<size_t>(popcount(word));
+
+		return visibleCount;
+	}
+
+	size_t Camera::CullSpheres(
+		span<const BoundingSphere> spheres,
+		vector<u64>& outVisible) const
+	{
+		const array<vec4, 6>& planes = GetFrustumPlanes();
+		CullPlanes simdPlanes = LoadCullPlanes(planes);
+
+		size_t count = spheres.size();
+		outVisible.assign((count + 63) / 64, 0);
+
+		const f32* data = reinterpret_cast<const f32*>(spheres.data());
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			const f32* s = data + i * 4;
+			__m128 cx = _mm_loadu_ps(s);
+			__m128 cy = _mm_loadu_ps(s + 4);
+			__m128 cz = _mm_loadu_ps(s + 8);
+			__m128 r = _mm_loadu_ps(s + 12);
+			_MM_TRANSPOSE4_PS(cx, cy, cz, r);
+
+			u64 bits = static_cast<u64>(_mm_movemask_ps(TestPlanes(
+				simdPlanes,
+				cx, cy, cz,
+				r, r, r,
+				true)));
+
+			outVisible[i >> 6] |= bits << (i & 63);
+		}
+		for (; i < count; ++i)
+		{
+			if (IsSphereVisible(planes, spheres[i])) outVisible[i >> 6] |= 1ull << (i & 63);
+		}
+
+		size_t visibleCount{};
+		for (u64 word : outVisible) visibleCount += static_cast<size_t>(popcount(word));
+
+		return visibleCount;
+	}
+
+	void Camera::UpdateMatrices() const
+	{
+		if (isViewDirty)
+		{
+			view = lookat(pos, pos + front, up);
+
+			//rigid transform, the inverse is the transposed rotation and the rotated negative translation
+			mat4& v = view;
+			mat4& i = inverseView;
+
+			i.m00 = v.m00; i.m01 = v.m10; i.m02 = v.m20; i.m03 = -(v.m00 * v.m03 + v.m10 * v.m13 + v.m20 * v.m23);
+			i.m10 = v.m01; i.m11 = v.m11; i.m12 = v.m21; i.m13 = -(v.m01 * v.m03 + v.m11 * v.m13 + v.m21 * v.m23);
+			i.m20 = v.m02; i.m21 = v.m12; i.m22 = v.m22; i.m23 = -(v.m02 * v.m03 + v.m12 * v.m13 + v.m22 * v.m23);
+			i.m30 = 0.0f;  i.m31 = 0.0f;  i.m32 = 0.0f;  i.m33 = 1.0f;
+		}
+
+		if (isProjectionDirty)
+		{
+			//standard OpenGL projection with -1 to 1 depth,
+			//math_utils perspective stores the last row and column the other way around
+			f32 f = 1.0f / tan(radians(fov) * 0.5f);
+			f32 range = farClip - nearClip;
+
+			mat4& m = projection;
+
+			m.m00 = f / aspectRatio; m.m01 = 0.0f; m.m02 = 0.0f;                           m.m03 = 0.0f;
+			m.m10 = 0.0f;            m.m11 = f;    m.m12 = 0.0f;                           m.m13 = 0.0f;
+			m.m20 = 0.0f;            m.m21 = 0.0f; m.m22 = -(farClip + nearClip) / range;  m.m23 = -(2.0f * farClip * nearClip) / range;
+			m.m30 = 0.0f;            m.m31 = 0.0f; m.m32 = -1.0f;                          m.m33 = 0.0f;
+
+			//only the diagonal and the lower right 2x2 block are set, both invert on their own
+			mat4& i = inverseProjection;
+
+			i.m00 = 1.0f / m.m00; i.m01 = 0.0f;         i.m02 = 0.0f;         i.m03 = 0.0f;
+			i.m10 = 0.0f;         i.m11 = 1.0f / m.m11; i.m12 = 0.0f;         i.m13 = 0.0f;
+			i.m20 = 0.0f;         i.m21 = 0.0f;         i.m22 = 0.0f;         i.m23 = -1.0f;
+			i.m30 = 0.0f;         i.m31 = 0.0f;         i.m32 = 1.0f / m.m23; i.m33 = m.m22 / m.m23;
+		}
+
+		viewProjection = MultiplyMatrices(projection, view);
+		inverseViewProjection = MultiplyMatrices(inverseView, inverseProjection);
+
+		//Gribb-Hartmann: each plane is the last row plus or minus one of the other rows
+		const f32* vp = reinterpret_cast<const f32*>(&viewProjection);
+		auto row = [vp](u32 r) { return vec4(vp[r], vp[4 + r], vp[8 + r], vp[12 + r]); };
+
+		vec4 r0 = row(0);
+		vec4 r1 = row(1);
+		vec4 r2 = row(2);
+		vec4 r3 = row(3);
+
+		frustumPlanes =
+		{
+			r3 + r0, //left
+			r3 - r0, //right
+			r3 + r1, //bottom
+			r3 - r1, //top
+			r3 + r2, //near
+			r3 - r2  //far
+		};
+
+		for (vec4& p : frustumPlanes)
+		{
+			f32 length = sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+			if (length > 0.0f) p = p * (1.0f / length);
+		}
+
+		isViewDirty = false;
+		isProjectionDirty = false;
+		isBlockDirty = true;
+	}
+
+	bool Camera::PackCameraBlocks()
+	{
+		span<Camera* const> cameras = registry.GetAllContent();
+
+		bool isLayoutChanged = blockIDs.size() != cameras.size();
+		if (!isLayoutChanged)
+		{
+			for (size_t i = 0; i < cameras.size(); ++i)
+			{
+				if (blockIDs[i] != cameras[i]->ID)
+				{
+					isLayoutChanged = true;
+					break;
+				}
+			}
+		}
+
+		if (isLayoutChanged)
+		{
+			cameraBlocks.resize(cameras.size());
+			blockIDs.resize(cameras.size());
+		}
+
+		bool isChanged = isLayoutChanged;
+
+		for (size_t i = 0; i < cameras.size(); ++i)
+		{
+			Camera* cam = cameras[i];
+
+			cam->FlushMatrices();
+
+			if (!isLayoutChanged
+				&& !cam->isBlockDirty)
+			{
+				continue;
+			}
+
+			CameraBlock& block = cameraBlocks[i];
+
+			block.view = cam->view;
+			block.projection = cam->projection;
+			block.viewProjection = cam->viewProjection;
+			block.inverseView = cam->inverseView;
+			block.inverseProjection = cam->inverseProjection;
+			block.inverseViewProjection = cam->inverseViewProjection;
+
+			block.posNear = vec4(cam->pos, cam->nearClip);
+			block.frontFar = vec4(cam->front, cam->farClip);
+			block.fovAspect = vec4(cam->fov, cam->aspectRatio, 0.0f, 0.0f);
+
+			blockIDs[i] = cam->ID;
+			cam->blockIndex = static_cast<u32>(i);
+			cam->isBlockDirty = false;
+
+			isChanged = true;
+		}
+
+		return isChanged;
+	}
 }
\ No newline at end of file
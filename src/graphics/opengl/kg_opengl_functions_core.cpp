@@ -55,12 +55,14 @@ CoreGLFunction functions[] =
     { "glDeleteVertexArrays",      reinterpret_cast<void**>(&glDeleteVertexArrays) },
     { "glDrawArrays",              reinterpret_cast<void**>(&glDrawArrays) },
     { "glDrawElements",            reinterpret_cast<void**>(&glDrawElements) },
+    { "glDrawElementsInstanced",   reinterpret_cast<void**>(&glDrawElementsInstanced) },
     { "glEnableVertexAttribArray", reinterpret_cast<void**>(&glEnableVertexAttribArray) },
     { "glGenBuffers",              reinterpret_cast<void**>(&glGenBuffers) },
     { "glGenVertexArrays",         reinterpret_cast<void**>(&glGenVertexArrays) },
     { "glGetVertexAttribiv",       reinterpret_cast<void**>(&glGetVertexAttribiv) },
     { "glGetVertexAttribPointerv", reinterpret_cast<void**>(&glGetVertexAttribPointerv) },
     { "glVertexAttribPointer",     reinterpret_cast<void**>(&glVertexAttribPointer) },
+    { "glVertexAttribDivisor",     reinterpret_cast<void**>(&glVertexAttribDivisor) },
     { "glCullFace",                reinterpret_cast<void**>(&glCullFace) },
 
     //
@@ -276,12 +278,14 @@ namespace KalaGraphics::Graphics::OpenGLFunctions
     PFNGLDELETEVERTEXARRAYSPROC      glDeleteVertexArrays      = nullptr;
     PFNGLDRAWARRAYSPROC              glDrawArrays              = nullptr;
     PFNGLDRAWELEMENTSPROC            glDrawElements            = nullptr;
+    PFNGLDRAWELEMENTSINSTANCEDPROC   glDrawElementsInstanced   = nullptr;
     PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArray = nullptr;
     PFNGLGENBUFFERSPROC              glGenBuffers              = nullptr;
     PFNGLGENVERTEXARRAYSPROC         glGenVertexArrays         = nullptr;
     PFNGLGETVERTEXATTRIBIVPROC       glGetVertexAttribiv       = nullptr;
     PFNGLGETVERTEXATTRIBPOINTERVPROC glGetVertexAttribPointerv = nullptr;
     PFNGLVERTEXATTRIBPOINTERPROC     glVertexAttribPointer     = nullptr;
+    PFNGLVERTEXATTRIBDIVISORPROC     glVertexAttribDivisor     = nullptr;
     PFNGLCULLFACEPROC                glCullFace                = nullptr;
 
     //
@@ -95,7 +95,7 @@ namespace KalaGraphics::Graphics::OpenGL
 			return nullptr;
 		}
 
-        u32 newID = ++KalaGraphicsCore::globalID;
+        u32 newID = KalaGraphicsCore::GetNewID();
         unique_ptr<OpenGL_Shader> newShader = make_unique<OpenGL_Shader>();
         OpenGL_Shader* shaderPtr = newShader.get();
 
@@ -0,0 +1,343 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "graphics/opengl/kg_opengl.hpp"
+#include "graphics/opengl/kg_opengl_functions_core.hpp"
+
+using namespace KalaGraphics::Graphics::OpenGLFunctions;
+
+using KalaGraphics::Graphics::OpenGL::GLState;
+using KalaGraphics::Graphics::OpenGL::GLStateStats;
+using KalaGraphics::Graphics::OpenGL::GL_STATE_UNKNOWN;
+using KalaGraphics::Graphics::OpenGL::MAX_SHADOWED_TEXTURE_UNITS;
+using KalaGraphics::Graphics::OpenGL::SHADOWED_TEXTURE_TARGET_COUNT;
+
+using u32 = uint32_t;
+
+//Returns true if the shadowed value already matches and the call can be skipped,
+//otherwise stores the new value and counts the call as issued
+static bool IsRedundant(
+	u32& shadowed,
+	u32 newValue,
+	GLStateStats& stats);
+
+//Slot of this target in one unit of GLState::boundTextures, SHADOWED_TEXTURE_TARGET_COUNT if not shadowed
+static u32 ToShadowedTextureTarget(u32 target);
+
+namespace KalaGraphics::Graphics::OpenGL
+{
+	void OpenGL_Core::SetBlendState(
+		u32 glID,
+		bool isEnabled)
+	{
+		GLContext* context = GetStateContext(glID);
+
+		if (context
+			&& IsRedundant(
+			context->state.isBlendEnabled,
+			isEnabled,
+			context->stateStats))
+		{
+			return;
+		}
+
+		if (isEnabled) glEnable(GL_BLEND);
+		else glDisable(GL_BLEND);
+	}
+	void OpenGL_Core::BlendFunc(
+		u32 glID,
+		u32 src,
+		u32 dst)
+	{
+		GLContext* context = GetStateContext(glID);
+
+		if (context)
+		{
+			GLState& state = context->state;
+
+			if (state.blendSrc == src
+				&& state.blendDst == dst)
+			{
+				++context->stateStats.skippedCallCount;
+				return;
+			}
+
+			state.blendSrc = src;
+			state.blendDst = dst;
+			++context->stateStats.issuedCallCount;
+		}
+
+		glBlendFunc(src, dst);
+	}
+
+	void OpenGL_Core::DepthMask(
+		u32 glID,
+		bool isEnabled)
+	{
+		GLContext* context = GetStateContext(glID);
+
+		if (context
+			&& IsRedundant(
+			context->state.isDepthMaskEnabled,
+			isEnabled,
+			context->stateStats))
+		{
+			return;
+		}
+
+		glDepthMask(isEnabled ? GL_TRUE : GL_FALSE);
+	}
+	void OpenGL_Core::SetDepthTestState(
+		u32 glID,
+		bool isEnabled)
+	{
+		GLContext* context = GetStateContext(glID);
+
+		if (context
+			&& IsRedundant(
+			context->state.isDepthTestEnabled,
+			isEnabled,
+			context->stateStats))
+		{
+			return;
+		}
+
+		if (isEnabled) glEnable(GL_DEPTH_TEST);
+		else glDisable(GL_DEPTH_TEST);
+	}
+
+	void OpenGL_Core::ActiveTexture(
+		u32 glID,
+		u32 unit)
+	{
+		GLContext* context = GetStateContext(glID);
+
+		if (context
+			&& IsRedundant(
+			context->state.activeTextureUnit,
+			unit - GL_TEXTURE0,
+			context->stateStats))
+		{
+			return;
+		}
+
+		glActiveTexture(unit);
+	}
+	void OpenGL_Core::BindTexture(
+		u32 glID,
+		u32 target,
+		u32 textureID)
+	{
+		GLContext* context = GetStateContext(glID);
+
+		if (!context)
+		{
+			glBindTexture(target, textureID);
+			return;
+		}
+
+		GLState& state = context->state;
+
+		u32 unit = state.activeTextureUnit;
+		u32 targetSlot = ToShadowedTextureTarget(target);
+
+		if (targetSlot == SHADOWED_TEXTURE_TARGET_COUNT
+			|| (unit >= MAX_SHADOWED_TEXTURE_UNITS
+			&& unit != GL_STATE_UNKNOWN))
+		{
+			++context->stateStats.issuedCallCount;
+			glBindTexture(target, textureID);
+
+			return;
+		}
+
+		//the bind lands on an unknown unit, so this target is unknown on every unit
+		if (unit == GL_STATE_UNKNOWN)
+		{
+			for (u32 i = 0; i < MAX_SHADOWED_TEXTURE_UNITS; ++i)
+			{
+				state.boundTextures[i * SHADOWED_TEXTURE_TARGET_COUNT + targetSlot] = GL_STATE_UNKNOWN;
+			}
+
+			++context->stateStats.issuedCallCount;
+			glBindTexture(target, textureID);
+
+			return;
+		}
+
+		if (IsRedundant(
+			state.boundTextures[unit * SHADOWED_TEXTURE_TARGET_COUNT + targetSlot],
+			textureID,
+			context->stateStats))
+		{
+			return;
+		}
+
+		glBindTexture(target, textureID);
+	}
+
+	void OpenGL_Core::BindVertexArray(
+		u32 glID,
+		u32 VAO)
+	{
+		GLContext* context = GetStateContext(glID);
+
+		if (context)
+		{
+			if (IsRedundant(
+				context->state.VAO,
+				VAO,
+				context->stateStats))
+			{
+				return;
+			}
+
+			context->state.elementBuffer = GL_STATE_UNKNOWN;
+		}
+
+		glBindVertexArray(VAO);
+	}
+	void OpenGL_Core::BindBuffer(
+		u32 glID,
+		u32 target,
+		u32 bufferID)
+	{
+		GLContext* context = GetStateContext(glID);
+
+		u32* shadowed{};
+		if (context)
+		{
+			if (target == GL_ARRAY_BUFFER) shadowed = &context->state.arrayBuffer;
+			else if (target == GL_ELEMENT_ARRAY_BUFFER) shadowed = &context->state.elementBuffer;
+		}
+
+		if (!shadowed)
+		{
+			if (context) ++context->stateStats.issuedCallCount;
+			glBindBuffer(target, bufferID);
+
+			return;
+		}
+
+		if (IsRedundant(
+			*shadowed,
+			bufferID,
+			context->stateStats))
+		{
+			return;
+		}
+
+		glBindBuffer(target, bufferID);
+	}
+
+	void OpenGL_Core::DeleteTexture(
+		u32 glID,
+		u32 textureID)
+	{
+		if (textureID == 0) return;
+
+		glDeleteTextures(1, &textureID);
+
+		//gl unbinds a deleted texture from every unit of the current context only,
+		//other contexts still hold the old object under a name that may be reused
+		for (auto& [id, context] : glContexts)
+		{
+			for (u32& bound : context.state.boundTextures)
+			{
+				if (bound == textureID) bound = id == glID ? 0 : GL_STATE_UNKNOWN;
+			}
+		}
+	}
+	void OpenGL_Core::DeleteVertexArray(
+		u32 glID,
+		u32 VAO)
+	{
+		if (VAO == 0) return;
+
+		glDeleteVertexArrays(1, &VAO);
+
+		GLContext* context = GetStateContext(glID);
+		if (context
+			&& context->state.VAO == VAO)
+		{
+			context->state.VAO = 0;
+			context->state.elementBuffer = GL_STATE_UNKNOWN;
+		}
+	}
+	void OpenGL_Core::DeleteBuffer(
+		u32 glID,
+		u32 bufferID)
+	{
+		if (bufferID == 0) return;
+
+		glDeleteBuffers(1, &bufferID);
+
+		for (auto& [id, context] : glContexts)
+		{
+			u32 unbound = id == glID ? 0 : GL_STATE_UNKNOWN;
+
+			if (context.state.arrayBuffer == bufferID) context.state.arrayBuffer = unbound;
+			if (context.state.elementBuffer == bufferID) context.state.elementBuffer = unbound;
+		}
+	}
+
+	GLContext* OpenGL_Core::GetStateContext(u32 glID)
+	{
+		if (glID == lastStateGLID
+			&& lastStateContext)
+		{
+			return lastStateContext;
+		}
+
+		//unknown contexts are not added here, that would make a later AssignGLContext fail
+		auto it = glContexts.find(glID);
+		if (it == glContexts.end()) return nullptr;
+
+		lastStateContext = &it->second;
+		lastStateGLID = glID;
+
+		return lastStateContext;
+	}
+
+	void OpenGL_Core::InvalidateGLState(u32 glID)
+	{
+		if (glContexts.contains(glID)) glContexts[glID].state = {};
+	}
+	void OpenGL_Core::InvalidateAllGLStates()
+	{
+		for (auto& [id, context] : glContexts)
+		{
+			context.state = {};
+		}
+	}
+}
+
+bool IsRedundant(
+	u32& shadowed,
+	u32 newValue,
+	GLStateStats& stats)
+{
+	if (shadowed == newValue)
+	{
+		++stats.skippedCallCount;
+		return true;
+	}
+
+	shadowed = newValue;
+	++stats.issuedCallCount;
+
+	return false;
+}
+
+u32 ToShadowedTextureTarget(u32 target)
+{
+	switch (target)
+	{
+	case GL_TEXTURE_2D:       return 0;
+	case GL_TEXTURE_2D_ARRAY: return 1;
+	case GL_TEXTURE_CUBE_MAP: return 2;
+	default:                  return SHADOWED_TEXTURE_TARGET_COUNT;
+	}
+}
\ No newline at end of file
@@ -212,7 +212,7 @@ namespace KalaGraphics::Graphics::OpenGL
 				GLenum target = ToGLTarget(type);
 				GLFormatInfo fmt = ToGLFormat(newFormat);
 
-				glBindTexture(target, newTextureID);
+				OpenGL_Core::BindTexture(glID, target, newTextureID);
 
 				glTexParameteri(
 					target,
@@ -365,7 +365,7 @@ namespace KalaGraphics::Graphics::OpenGL
 				//
 
 				glGenTextures(1, &newTextureID);
-				glBindTexture(GL_TEXTURE_CUBE_MAP, newTextureID);
+				OpenGL_Core::BindTexture(glID, GL_TEXTURE_CUBE_MAP, newTextureID);
 
 				glTexParameteri(
 					GL_TEXTURE_CUBE_MAP,
@@ -490,7 +490,7 @@ namespace KalaGraphics::Graphics::OpenGL
 				//
 
 				glGenTextures(1, &newTextureID);
-				glBindTexture(GL_TEXTURE_2D_ARRAY, newTextureID);
+				OpenGL_Core::BindTexture(glID, GL_TEXTURE_2D_ARRAY, newTextureID);
 
 				glTexParameteri(
 					GL_TEXTURE_2D_ARRAY,
@@ -538,7 +538,9 @@ namespace KalaGraphics::Graphics::OpenGL
 			unsigned int newTextureID{};
 			glGenTextures(1, &newTextureID);
 
+			//the fallback texture belongs to no gl context, so no shadowed binding can be trusted after this
 			glBindTexture(GL_TEXTURE_2D, newTextureID);
+			OpenGL_Core::InvalidateAllGLStates();
 
 			//reset state
 			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
@@ -568,7 +570,7 @@ namespace KalaGraphics::Graphics::OpenGL
 
 			glGenerateMipmap(GL_TEXTURE_2D);
 
-			u32 newID = ++KalaGraphicsCore::globalID;
+			u32 newID = KalaGraphicsCore::GetNewID();
 			unique_ptr<OpenGL_Texture> newTexture = make_unique<OpenGL_Texture>();
 			OpenGL_Texture* texturePtr = newTexture.get();
 
@@ -634,7 +636,7 @@ namespace KalaGraphics::Graphics::OpenGL
 			return nullptr;
 		}
 
-		u32 newID = ++KalaGraphicsCore::globalID;
+		u32 newID = KalaGraphicsCore::GetNewID();
 		unique_ptr<OpenGL_Texture> newTexture = make_unique<OpenGL_Texture>();
 		OpenGL_Texture* texturePtr = newTexture.get();
 
@@ -956,7 +958,7 @@ namespace KalaGraphics::Graphics::OpenGL
 	{
 		GLenum targetType = ToGLTarget(type);
 		
-		glBindTexture(targetType, textureID);
+		OpenGL_Core::BindTexture(glID, targetType, textureID);
 
 		GLFormatInfo fmt = ToGLFormat(format);
 
@@ -1180,7 +1182,7 @@ namespace KalaGraphics::Graphics::OpenGL
 
 		if (textureID != 0)
 		{
-			glDeleteTextures(1, &textureID);
+			OpenGL_Core::DeleteTexture(glID, textureID);
 			textureID = 0;
 		}
 	}
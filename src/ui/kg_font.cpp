@@ -37,7 +37,7 @@ namespace KalaGraphics::UI
 		const string& name,
 		const string& fontPath)
 	{
-		u32 newID = ++KalaGraphicsCore::globalID;
+		u32 newID = KalaGraphicsCore::GetNewID();
 		unique_ptr<Font> newFont = make_unique<Font>();
 		Font* fontPtr = newFont.get();
 
@@ -71,10 +71,18 @@ namespace KalaGraphics::UI
 		fontPtr->tables = move(tables);
 		fontPtr->blocks = move(blocks);
 		fontPtr->ID = newID;
-		fontPtr->SetName(name);
+		//the registry indexes the name when the font is added, SetName would read the registry
+		//from the loader thread while the main thread may be changing it
+		if (!name.empty()
+			&& name.length() <= 50)
+		{
+			fontPtr->name = name;
+		}
 		fontPtr->fontPath = fontPath;
 
-		registry.AddContent(newID, move(newFont));
+		//fonts loaded on a loader thread become visible after the main thread flushes the font registry
+		if (KalaGraphicsCore::IsMainThread()) registry.AddContent(newID, move(newFont));
+		else registry.QueueContent(newID, move(newFont));
 
 		Log::Print(
 			"Loaded font '" + name + "' with ID '" + to_string(newID) + "'!",
@@ -4,10 +4,12 @@
 //Read LICENSE.md for more information.
 
 #include <memory>
+#include <algorithm>
 
 #include "KalaHeaders/log_utils.hpp"
 
 #include "ui/kg_image.hpp"
+#include "utils/kg_transform_batch2D.hpp"
 #include "core/kg_core.hpp"
 #include "graphics/opengl/kg_opengl_functions_core.hpp"
 #include "graphics/opengl/kg_opengl_texture.hpp"
@@ -18,16 +20,33 @@ using KalaHeaders::LogType;
 
 using KalaGraphics::Core::KalaGraphicsCore;
 using namespace KalaGraphics::Graphics::OpenGLFunctions;
-using KalaGraphics::Graphics::TextureFormat;
 using KalaGraphics::Graphics::OpenGL::OpenGL_Core;
 using KalaGraphics::Graphics::OpenGL::GLContext;
+using KalaGraphics::Utils::TransformBatch2D;
 
 using std::unique_ptr;
 using std::make_unique;
 using std::to_string;
+using std::sort;
+using std::max;
 
 namespace KalaGraphics::UI
 {
+	static_assert(sizeof(ImageInstance) == sizeof(f32) * 24, "Instance attributes expect a tightly packed mat4 and two vec4s!");
+
+	//Below this opacity the quad shaders discard every fragment, such images are skipped by the batch
+	constexpr f32 MIN_VISIBLE_OPACITY = 0.1f;
+
+	//Batch sort key layout, Z order fits in 11 bits because it is clamped to MAX_Z_ORDER
+	constexpr u32 BATCH_ORDER_BITS = 20;
+	constexpr u32 BATCH_TEXTURE_SHIFT = BATCH_ORDER_BITS;
+	constexpr u32 BATCH_ALPHA_SHIFT = BATCH_TEXTURE_SHIFT + 32;
+	constexpr u32 BATCH_Z_SHIFT = BATCH_ALPHA_SHIFT + 1;
+	constexpr u64 BATCH_ORDER_MASK = (1ull << BATCH_ORDER_BITS) - 1;
+	constexpr u32 MAX_BATCH_IMAGES = 1u << BATCH_ORDER_BITS;
+
+	static_assert(MAX_Z_ORDER < (1u << (64 - BATCH_Z_SHIFT)), "Z order does not fit in the batch sort key!");
+
 	Image* Image::Initialize(
 		u32 windowID,
 		u32 glID,
@@ -51,7 +70,7 @@ namespace KalaGraphics::UI
 			return nullptr;
 		}
 
-		u32 newID = ++KalaGraphicsCore::globalID;
+		u32 newID = KalaGraphicsCore::GetNewID();
 		unique_ptr<Image> newImage = make_unique<Image>();
 		Image* imagePtr = newImage.get();
 
@@ -88,25 +107,12 @@ namespace KalaGraphics::UI
 		}
 		imagePtr->render.shader = shader;
 
-		//parent is optional
-		if (parentWidget
-			&& parentWidget->IsInitialized())
-		{
-			registry.hierarchy[imagePtr].SetParent(parentWidget);
-		}
-
-		Widget::CreateWidgetGeometry(
-			imagePtr->render.vertices,
-			imagePtr->render.indices,
-			{
-				0, 1,
-				1, 1,
-				1, 0,
-				0, 0
-			},
-			imagePtr->render.VAO,
-			imagePtr->render.VBO,
-			imagePtr->render.EBO);
+		//every image draws the same quad, only the first one per gl context creates buffers
+		imagePtr->render.geometryID = AcquireGeometry(
+			glID,
+			WIDGET_QUAD_VERTICES,
+			WIDGET_QUAD_INDICES,
+			WIDGET_QUAD_UVS);
 
 		imagePtr->transform = Transform2D::Initialize();
 
@@ -124,6 +130,17 @@ namespace KalaGraphics::UI
 
 		registry.AddContent(newID, move(newImage));
 
+		imagePtr->imageIndex = static_cast<u32>(images.size());
+		images.push_back(imagePtr);
+
+		//parent is optional, linked after registering so this widget has a hierarchy node
+		if (parentWidget
+			&& parentWidget->IsInitialized())
+		{
+			registry.GetHierarchy(imagePtr).SetParent(parentWidget);
+			imagePtr->transform->SetParent(parentWidget->GetTransform());
+		}
+
 		Log::Print(
 			"Loaded image '" + name + "' with ID '" + to_string(newID) + "'!",
 			"IMAGE",
@@ -186,82 +203,331 @@ namespace KalaGraphics::UI
 			return false;
 		}
 		
-		//ensure AABB is up to date if pos, rot or size of the image changes
-		if (transform->GetPos(PosTarget::POS_COMBINED) != lastPos
-			|| transform->GetRot(RotTarget::ROT_COMBINED) != lastRot
-			|| transform->GetSize(SizeTarget::SIZE_COMBINED) != lastSize)
-		{
-			UpdateAABB();
-			
-			lastPos = transform->GetPos(PosTarget::POS_COMBINED);
-			lastRot = transform->GetRot(RotTarget::ROT_COMBINED);
-			lastSize = transform->GetSize(SizeTarget::SIZE_COMBINED);
-			
-			Log::Print(
-				"Updated AABB for image '" + name + "'.",
-				"IMAGE",
-				LogType::LOG_DEBUG);
-		}
+		UpdateAABBIfMoved();
 
 		u32 programID = render.shader->GetProgramID();
 
-		vec2 pos = transform->GetPos(PosTarget::POS_COMBINED);
-		float rot = transform->GetRot(RotTarget::ROT_COMBINED);
-		vec2 size = transform->GetSize(SizeTarget::SIZE_COMBINED);
-
-		mat4 model = createumodel(pos, rot, size);
+		//all image models are built together by the batch solver once per frame
+		mat4 model = TransformBatch2D::GetModel(transform);
 
 		render.shader->SetMat4(programID, "uModel", model);
 		render.shader->SetMat4(programID, "uProjection", projection);
+		render.shader->SetVec4(programID, "uUVRect", uvRect);
 
-		bool isOpaque = render.opacity = 1.0f;
-		bool isTransparentTexture = 
-			render.texture
-			&& (render.texture->GetFormat() == TextureFormat::Format_RGBA8
-			|| render.texture->GetFormat() == TextureFormat::Format_RGBA16F
-			|| render.texture->GetFormat() == TextureFormat::Format_RGBA32F
-			|| render.texture->GetFormat() == TextureFormat::Format_SRGB8A8);
+		bool isAlpha = IsAlphaBlended();
 
-		bool isAlpha =
-			isOpaque
-			|| isTransparentTexture;
-
-		if (isAlpha)
-		{
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-			glDepthMask(GL_FALSE);
-		}
+		//state is not restored after the draw, the next widget only changes what differs
+		OpenGL_Core::SetBlendState(glID, isAlpha);
+		if (isAlpha) OpenGL_Core::BlendFunc(glID, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		OpenGL_Core::DepthMask(glID, !isAlpha);
 
 		render.shader->SetVec3(programID, "uColor", render.color);
 		render.shader->SetFloat(programID, "uOpacity", render.opacity);
 
 		if (render.texture)
 		{
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, render.texture->GetTextureID());
+			OpenGL_Core::ActiveTexture(glID, GL_TEXTURE0);
+			OpenGL_Core::BindTexture(glID, GL_TEXTURE_2D, render.texture->GetTextureID());
 			render.shader->SetInt(programID, "uTexture", 0);
 			render.shader->SetBool(programID, "uUseTexture", true);
 		}
 		else render.shader->SetBool(programID, "uUseTexture", false);
 
-		glBindVertexArray(render.VAO);
+		const WidgetGeometry& geometry = GetGeometry(render.geometryID);
+
+		OpenGL_Core::BindVertexArray(glID, geometry.VAO);
 		glDrawElements(
 			GL_TRIANGLES,
-			render.indices.size(),
+			geometry.indices.size(),
 			GL_UNSIGNED_INT,
 			0);
-		glBindVertexArray(0);
 
-		if (isAlpha)
+		return true;
+	}
+
+	bool Image::RenderBatch(
+		u32 glID,
+		uintptr_t handle,
+		const mat4& projection,
+		OpenGL_Shader* batchShader)
+	{
+		batchStats = {};
+
+		if (!batchShader)
+		{
+			Log::Print(
+				"Failed to render image batch because its shader is unassigned!",
+				"IMAGE",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		if (!handle)
+		{
+			Log::Print(
+				"Failed to render image batch because its handle is unassigned!",
+				"IMAGE",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		//
+		// GATHER AND SORT
+		//
+
+		batchKeys.clear();
+		batchImages.clear();
+
+		if (removedImageCount > 0)
+		{
+			size_t kept{};
+			for (Image* image : images)
+			{
+				if (!image) continue;
+
+				image->imageIndex = static_cast<u32>(kept);
+				images[kept++] = image;
+			}
+
+			images.resize(kept);
+			removedImageCount = 0;
+		}
+
+		for (Image* image : images)
+		{
+			if (image->glID != glID
+				|| !image->render.canUpdate
+				|| image->render.opacity < MIN_VISIBLE_OPACITY)
+			{
+				continue;
+			}
+
+			if (batchImages.size() == MAX_BATCH_IMAGES)
+			{
+				Log::Print(
+					"Image batch reached its limit of '" + to_string(MAX_BATCH_IMAGES) + "' images, the rest are skipped!",
+					"IMAGE",
+					LogType::LOG_ERROR,
+					2);
+
+				break;
+			}
+
+			image->UpdateAABBIfMoved();
+
+			u32 textureID = image->render.texture
+				? image->render.texture->GetTextureID()
+				: 0;
+
+			batchKeys.push_back(
+				(static_cast<u64>(image->zOrder) << BATCH_Z_SHIFT)
+				| (static_cast<u64>(image->IsAlphaBlended()) << BATCH_ALPHA_SHIFT)
+				| (static_cast<u64>(textureID) << BATCH_TEXTURE_SHIFT)
+				| batchImages.size());
+			batchImages.push_back(image);
+		}
+
+		if (batchKeys.empty()) return true;
+
+		sort(batchKeys.begin(), batchKeys.end());
+
+		//
+		// BUILD INSTANCES
+		//
+
+		//all image models are built together by the batch solver once per frame,
+		//read straight from the solved view instead of solving again per image
+		span<const mat4> models = TransformBatch2D::Solve();
+
+		u32 count = static_cast<u32>(batchKeys.size());
+		batchInstances.resize(count);
+
+		for (u32 i = 0; i < count; ++i)
 		{
-			glDisable(GL_BLEND);
-			glDepthMask(GL_TRUE);
+			const Image* image = batchImages[batchKeys[i] & BATCH_ORDER_MASK];
+			ImageInstance& instance = batchInstances[i];
+
+			u32 traversalIndex = Transform2D::registry.GetHierarchy(image->transform).traversalIndex;
+			instance.model = traversalIndex < models.size()
+				? models[traversalIndex]
+				: TransformBatch2D::GetModel(image->transform);
+			instance.colorOpacity = vec4(image->render.color, image->render.opacity);
+			instance.uvRect = image->uvRect;
 		}
 
+		if (!batchShader->Bind(glID, handle))
+		{
+			Log::Print(
+				"Failed to render image batch because its shader '" + batchShader->GetName() + "' failed to bind!",
+				"IMAGE",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		//
+		// UPLOAD
+		//
+
+		ImageBatchGeometry& geometry = batchGeometry[glID];
+		if (geometry.VAO == 0) CreateBatchGeometry(glID, geometry);
+
+		OpenGL_Core::BindVertexArray(glID, geometry.VAO);
+		OpenGL_Core::BindBuffer(glID, GL_ARRAY_BUFFER, geometry.instanceVBO);
+
+		size_t byteCount = count * sizeof(ImageInstance);
+		if (byteCount > geometry.instanceCapacity)
+		{
+			geometry.instanceCapacity = max(byteCount, geometry.instanceCapacity * 2);
+		}
+
+		//orphaning the old storage lets the driver keep drawing from it while this frame is written
+		glBufferData(
+			GL_ARRAY_BUFFER,
+			geometry.instanceCapacity,
+			nullptr,
+			GL_STREAM_DRAW);
+		glBufferSubData(
+			GL_ARRAY_BUFFER,
+			0,
+			byteCount,
+			batchInstances.data());
+
+		//
+		// DRAW
+		//
+
+		u32 programID = batchShader->GetProgramID();
+
+		batchShader->SetMat4(programID, "uProjection", projection);
+		batchShader->SetInt(programID, "uTexture", 0);
+		OpenGL_Core::ActiveTexture(glID, GL_TEXTURE0);
+
+		bool isBlending{};
+		bool isTextureBound{};
+		u32 boundTextureID{};
+
+		u32 runStart = 0;
+		while (runStart < count)
+		{
+			//images of one run share everything above the gather position
+			u64 runKey = batchKeys[runStart] >> BATCH_ORDER_BITS;
+
+			u32 runEnd = runStart + 1;
+			while (runEnd < count
+				&& (batchKeys[runEnd] >> BATCH_ORDER_BITS) == runKey)
+			{
+				++runEnd;
+			}
+
+			bool isAlpha = (batchKeys[runStart] >> BATCH_ALPHA_SHIFT) & 1;
+			u32 textureID = static_cast<u32>(batchKeys[runStart] >> BATCH_TEXTURE_SHIFT);
+
+			//set on every run because the state left by earlier renders is not known here,
+			//the state filter drops the calls that change nothing
+			OpenGL_Core::SetBlendState(glID, isAlpha);
+			if (isAlpha) OpenGL_Core::BlendFunc(glID, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			OpenGL_Core::DepthMask(glID, !isAlpha);
+
+			if (isAlpha != isBlending)
+			{
+				isBlending = isAlpha;
+				++batchStats.blendToggleCount;
+			}
+
+			if (!isTextureBound
+				|| textureID != boundTextureID)
+			{
+				OpenGL_Core::BindTexture(glID, GL_TEXTURE_2D, textureID);
+				batchShader->SetBool(programID, "uUseTexture", textureID != 0);
+
+				boundTextureID = textureID;
+				isTextureBound = true;
+				++batchStats.textureBindCount;
+			}
+
+			SetInstanceOffset(runStart);
+			glDrawElementsInstanced(
+				GL_TRIANGLES,
+				6,
+				GL_UNSIGNED_INT,
+				0,
+				runEnd - runStart);
+
+			++batchStats.drawCallCount;
+
+			runStart = runEnd;
+		}
+
+		batchStats.instanceCount = count;
+
 		return true;
 	}
 
+	void Image::CreateBatchGeometry(
+		u32 targetGLID,
+		ImageBatchGeometry& geometry)
+	{
+		//same unit quad and uvs as a single image, with its own VAO for the instance attributes
+		Widget::CreateWidgetGeometry(
+			targetGLID,
+			WIDGET_QUAD_VERTICES,
+			WIDGET_QUAD_INDICES,
+			WIDGET_QUAD_UVS,
+			geometry.VAO,
+			geometry.VBO,
+			geometry.EBO);
+
+		OpenGL_Core::BindVertexArray(targetGLID, geometry.VAO);
+
+		glGenBuffers(1, &geometry.instanceVBO);
+		OpenGL_Core::BindBuffer(targetGLID, GL_ARRAY_BUFFER, geometry.instanceVBO);
+
+		//model - layout 2 to 5, color - layout 6, uv rect - layout 7
+		for (u32 location = 2; location <= 7; ++location)
+		{
+			glEnableVertexAttribArray(location);
+			glVertexAttribDivisor(location, 1);
+		}
+	}
+
+	void Image::SetInstanceOffset(u32 firstInstance)
+	{
+		size_t base = firstInstance * sizeof(ImageInstance);
+
+		//mat4 attributes take one location per column
+		for (u32 column = 0; column < 4; ++column)
+		{
+			glVertexAttribPointer(
+				2 + column,
+				4,
+				GL_FLOAT,
+				GL_FALSE,
+				sizeof(ImageInstance),
+				(void*)(base + offsetof(ImageInstance, model) + column * sizeof(vec4)));
+		}
+
+		glVertexAttribPointer(
+			6,
+			4,
+			GL_FLOAT,
+			GL_FALSE,
+			sizeof(ImageInstance),
+			(void*)(base + offsetof(ImageInstance, colorOpacity)));
+		glVertexAttribPointer(
+			7,
+			4,
+			GL_FLOAT,
+			GL_FALSE,
+			sizeof(ImageInstance),
+			(void*)(base + offsetof(ImageInstance, uvRect)));
+	}
+
 	Image::~Image()
 	{
 		if (!isInitialized)
@@ -275,29 +541,18 @@ namespace KalaGraphics::UI
 			return;
 		}
 
+		//compacted by the next batch so destroying many images never shifts the vector
+		if (imageIndex < images.size()
+			&& images[imageIndex] == this)
+		{
+			images[imageIndex] = nullptr;
+			++removedImageCount;
+		}
+
+		//the shared quad is released by the widget destructor
 		Log::Print(
 			"Destroying widget '" + name + "' with ID '" + to_string(ID) + "'.",
 			"WIDGET",
 			LogType::LOG_INFO);
-
-		u32 vao = GetVAO();
-		u32 vbo = GetVBO();
-		u32 ebo = GetEBO();
-
-		if (vao != 0)
-		{
-			glDeleteVertexArrays(1, &vao);
-			vao = 0;
-		}
-		if (vbo != 0)
-		{
-			glDeleteBuffers(1, &vbo);
-			vbo = 0;
-		}
-		if (ebo != 0)
-		{
-			glDeleteBuffers(1, &ebo);
-			ebo = 0;
-		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,316 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <algorithm>
+#include <array>
+
+#include "KalaHeaders/log_utils.hpp"
+
+#include "ui/kg_render_queue.hpp"
+
+using KalaHeaders::Log;
+using KalaHeaders::LogType;
+
+using std::array;
+using std::sort;
+using std::merge;
+using std::min;
+using std::swap;
+using std::to_string;
+
+namespace KalaGraphics::UI
+{
+	//Sort key layout, Z order fits in 11 bits because it is clamped to MAX_Z_ORDER
+	constexpr u32 QUEUE_SLOT_BITS = 20;
+	constexpr u32 QUEUE_ID_BITS = 16;
+	constexpr u32 QUEUE_TEXTURE_SHIFT = QUEUE_SLOT_BITS;
+	constexpr u32 QUEUE_SHADER_SHIFT = QUEUE_TEXTURE_SHIFT + QUEUE_ID_BITS;
+	constexpr u32 QUEUE_BLEND_SHIFT = QUEUE_SHADER_SHIFT + QUEUE_ID_BITS;
+	constexpr u32 QUEUE_Z_SHIFT = QUEUE_BLEND_SHIFT + 1;
+	constexpr u64 QUEUE_SLOT_MASK = (1ull << QUEUE_SLOT_BITS) - 1;
+	constexpr u64 QUEUE_ID_MASK = (1ull << QUEUE_ID_BITS) - 1;
+	constexpr u32 MAX_QUEUED_WIDGETS = 1u << QUEUE_SLOT_BITS;
+
+	static_assert(MAX_Z_ORDER < (1u << (64 - QUEUE_Z_SHIFT)), "Z order does not fit in the render queue sort key!");
+
+	//Radix digit width, 256 buckets per histogram keep all histograms of one sort in L1
+	constexpr u32 RADIX_BITS = 8;
+	constexpr u32 RADIX_BUCKETS = 1u << RADIX_BITS;
+	constexpr u32 RADIX_PASSES = (64 - QUEUE_SLOT_BITS + RADIX_BITS - 1) / RADIX_BITS;
+
+	//A sort merges the changed keys into the previous order while at most
+	//one key in this many changed, otherwise the whole queue is radix sorted again
+	constexpr size_t INCREMENTAL_SORT_RATIO = 16;
+
+	//LSD radix sort of the bits above the slot bits. Keys are built in slot order and every pass
+	//is stable, so the slot bits end up ascending without sorting them. Histograms of all passes
+	//are counted in one read, passes where every key shares the same digit are skipped
+	static u32 RadixSortKeys(
+		vector<u64>& keys,
+		vector<u64>& scratch)
+	{
+		size_t count = keys.size();
+		if (count < 2) return 0;
+
+		array<array<u32, RADIX_BUCKETS>, RADIX_PASSES> histograms{};
+
+		for (u64 key : keys)
+		{
+			for (u32 pass = 0; pass < RADIX_PASSES; ++pass)
+			{
+				++histograms[pass][(key >> (QUEUE_SLOT_BITS + pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)];
+			}
+		}
+
+		scratch.resize(count);
+
+		u64* source = keys.data();
+		u64* target = scratch.data();
+		u32 passCount{};
+
+		for (u32 pass = 0; pass < RADIX_PASSES; ++pass)
+		{
+			u32 shift = QUEUE_SLOT_BITS + pass * RADIX_BITS;
+			array<u32, RADIX_BUCKETS>& histogram = histograms[pass];
+
+			if (histogram[(source[0] >> shift) & (RADIX_BUCKETS - 1)] == count) continue;
+
+			u32 offset{};
+			for (u32& bucket : histogram)
+			{
+				u32 bucketCount = bucket;
+				bucket = offset;
+				offset += bucketCount;
+			}
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				u64 key = source[i];
+				target[histogram[(key >> shift) & (RADIX_BUCKETS - 1)]++] = key;
+			}
+
+			swap(source, target);
+			++passCount;
+		}
+
+		if (source != keys.data()) keys.swap(scratch);
+
+		return passCount;
+	}
+
+	bool WidgetRenderQueue::Submit(Widget* widget)
+	{
+		if (!widget)
+		{
+			Log::Print(
+				"Cannot submit widget to render queue because it is nullptr!",
+				"WIDGET",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		if (widget->isInRenderQueue) return true;
+
+		RenderQueueData& queue = queues[widget->glID];
+
+		if (queue.widgets.size() == MAX_QUEUED_WIDGETS)
+		{
+			Log::Print(
+				"Cannot submit widget '" + widget->name + "' because the render queue of gl context '" + to_string(widget->glID) + "' reached its limit of '" + to_string(MAX_QUEUED_WIDGETS) + "' widgets!",
+				"WIDGET",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		widget->renderQueueSlot = static_cast<u32>(queue.widgets.size());
+		widget->isInRenderQueue = true;
+
+		queue.widgets.push_back(widget);
+
+		return true;
+	}
+
+	void WidgetRenderQueue::Remove(Widget* widget)
+	{
+		if (!widget
+			|| !widget->isInRenderQueue)
+		{
+			return;
+		}
+
+		RenderQueueData& queue = queues[widget->glID];
+
+		//compacted by the next sort so later slots keep their order without shifting now
+		queue.widgets[widget->renderQueueSlot] = nullptr;
+		++queue.removedCount;
+
+		widget->isInRenderQueue = false;
+
+		//the sorted view must never hand out a destroyed widget
+		queue.sortedWidgets.clear();
+	}
+
+	void WidgetRenderQueue::Clear(u32 glID)
+	{
+		if (!queues.contains(glID)) return;
+
+		for (Widget* widget : queues[glID].widgets)
+		{
+			if (widget) widget->isInRenderQueue = false;
+		}
+
+		queues.erase(glID);
+	}
+
+	const vector<Widget*>& WidgetRenderQueue::Sort(u32 glID)
+	{
+		RenderQueueData& queue = queues[glID];
+		RenderQueueStats& stats = queue.stats;
+
+		stats = {};
+
+		if (queue.removedCount > 0)
+		{
+			size_t kept{};
+			for (Widget* widget : queue.widgets)
+			{
+				if (!widget) continue;
+
+				widget->renderQueueSlot = static_cast<u32>(kept);
+				queue.widgets[kept++] = widget;
+			}
+
+			queue.widgets.resize(kept);
+			queue.removedCount = 0;
+
+			//every slot after the first removed one moved, so no previous key is reusable
+			queue.isFullSortNeeded = true;
+		}
+
+		size_t count = queue.widgets.size();
+
+		queue.slotKeys.resize(count);
+		queue.changedKeys.clear();
+
+		for (size_t slot = 0; slot < count; ++slot)
+		{
+			u64 key = MakeSortKey(
+				queue.widgets[slot],
+				static_cast<u32>(slot));
+
+			if (slot >= queue.sortedSlotCount
+				|| key != queue.slotKeys[slot])
+			{
+				queue.slotKeys[slot] = key;
+				queue.changedKeys.push_back(key);
+			}
+		}
+
+		stats.widgetCount = static_cast<u32>(count);
+		stats.changedKeyCount = static_cast<u32>(queue.changedKeys.size());
+
+		if (queue.isFullSortNeeded
+			|| queue.changedKeys.size() * INCREMENTAL_SORT_RATIO > count)
+		{
+			stats.changedKeyCount = static_cast<u32>(count);
+
+			queue.sortedKeys = queue.slotKeys;
+			stats.radixPassCount = RadixSortKeys(
+				queue.sortedKeys,
+				queue.scratchKeys);
+		}
+		else if (!queue.changedKeys.empty())
+		{
+			stats.isIncremental = true;
+
+			//drop the old keys of changed slots, slots are unique so a key still matching its slot is current
+			size_t kept{};
+			for (u64 key : queue.sortedKeys)
+			{
+				if (queue.slotKeys[key & QUEUE_SLOT_MASK] == key) queue.sortedKeys[kept++] = key;
+			}
+			queue.sortedKeys.resize(kept);
+
+			//few keys by definition, a comparison sort beats the fixed cost of the radix histograms here
+			sort(queue.changedKeys.begin(), queue.changedKeys.end());
+
+			queue.scratchKeys.resize(kept + queue.changedKeys.size());
+			merge(
+				queue.sortedKeys.begin(),
+				queue.sortedKeys.end(),
+				queue.changedKeys.begin(),
+				queue.changedKeys.end(),
+				queue.scratchKeys.begin());
+			queue.sortedKeys.swap(queue.scratchKeys);
+		}
+		else stats.isIncremental = true;
+
+		queue.sortedSlotCount = count;
+		queue.isFullSortNeeded = false;
+
+		queue.sortedWidgets.resize(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			u64 key = queue.sortedKeys[i];
+			queue.sortedWidgets[i] = queue.widgets[key & QUEUE_SLOT_MASK];
+
+			if (i == 0) continue;
+
+			u64 previous = queue.sortedKeys[i - 1];
+
+			if (((key >> QUEUE_SHADER_SHIFT) & QUEUE_ID_MASK) != ((previous >> QUEUE_SHADER_SHIFT) & QUEUE_ID_MASK)) ++stats.shaderSwitchCount;
+			if (((key >> QUEUE_TEXTURE_SHIFT) & QUEUE_ID_MASK) != ((previous >> QUEUE_TEXTURE_SHIFT) & QUEUE_ID_MASK)) ++stats.textureSwitchCount;
+			if (((key >> QUEUE_BLEND_SHIFT) & 1) != ((previous >> QUEUE_BLEND_SHIFT) & 1)) ++stats.blendSwitchCount;
+		}
+
+		return queue.sortedWidgets;
+	}
+
+	bool WidgetRenderQueue::Render(
+		u32 glID,
+		uintptr_t handle,
+		const mat4& projection)
+	{
+		if (!handle)
+		{
+			Log::Print(
+				"Failed to render widget queue of gl context '" + to_string(glID) + "' because its handle is unassigned!",
+				"WIDGET",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		for (Widget* widget : Sort(glID))
+		{
+			widget->Render(handle, projection);
+		}
+
+		return true;
+	}
+
+	u64 WidgetRenderQueue::MakeSortKey(
+		const Widget* widget,
+		u32 slot)
+	{
+		const OpenGL_Shader* shader = widget->GetShader();
+
+		u64 zOrder = min(widget->GetZOrder(), MAX_Z_ORDER);
+		u64 isAlpha = widget->IsAlphaBlended() ? 1 : 0;
+		u64 shaderID = shader ? shader->GetProgramID() & QUEUE_ID_MASK : 0;
+		u64 textureID = widget->GetDrawTextureID() & QUEUE_ID_MASK;
+
+		return (zOrder << QUEUE_Z_SHIFT)
+			| (isAlpha << QUEUE_BLEND_SHIFT)
+			| (shaderID << QUEUE_SHADER_SHIFT)
+			| (textureID << QUEUE_TEXTURE_SHIFT)
+			| (slot & QUEUE_SLOT_MASK);
+	}
+}
\ No newline at end of file
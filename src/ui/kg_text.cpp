@@ -23,7 +23,6 @@ using KalaHeaders::GlyphBlock;
 
 using KalaGraphics::Core::KalaGraphicsCore;
 using namespace KalaGraphics::Graphics::OpenGLFunctions;
-using KalaGraphics::Graphics::TextureFormat;
 using KalaGraphics::Graphics::OpenGL::OpenGL_Core;
 using KalaGraphics::Graphics::OpenGL::GLContext;
 
@@ -58,7 +57,7 @@ namespace KalaGraphics::UI
 			return nullptr;
 		}
 
-		u32 newID = ++KalaGraphicsCore::globalID;
+		u32 newID = KalaGraphicsCore::GetNewID();
 		unique_ptr<Text> newText = make_unique<Text>();
 		Text* textPtr = newText.get();
 
@@ -88,13 +87,6 @@ namespace KalaGraphics::UI
 		}
 		textPtr->render.shader = shader;
 
-		//parent is optional
-		if (parentWidget
-			&& parentWidget->IsInitialized())
-		{
-			registry.hierarchy[textPtr].SetParent(parentWidget);
-		}
-
 		//font is required
 		Font* font{};
 		if (fontID == 0) 
@@ -138,7 +130,7 @@ namespace KalaGraphics::UI
 		const auto& glyph = glyphs[glyphIndex];
 		
 		glGenTextures(1, &textPtr->textureID);
-		glBindTexture(GL_TEXTURE_2D, textPtr->textureID);
+		OpenGL_Core::BindTexture(glID, GL_TEXTURE_2D, textPtr->textureID);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -181,16 +173,12 @@ namespace KalaGraphics::UI
 		uvs.push_back(static_cast<u32>(header.uvs[3][0]));
 		uvs.push_back(static_cast<u32>(header.uvs[3][1]));
 		
-		textPtr->render.vertices = verts;
-		textPtr->render.indices = inds;
-
-		Widget::CreateWidgetGeometry(
-			textPtr->render.vertices,
-			textPtr->render.indices,
-			uvs,
-			textPtr->render.VAO,
-			textPtr->render.VBO,
-			textPtr->render.EBO);
+		//texts showing the same glyph share one buffer set
+		textPtr->render.geometryID = AcquireGeometry(
+			glID,
+			verts,
+			inds,
+			uvs);
 
 		textPtr->transform = Transform2D::Initialize();
 
@@ -210,6 +198,14 @@ namespace KalaGraphics::UI
 
 		registry.AddContent(newID, move(newText));
 
+		//parent is optional, linked after registering so this widget has a hierarchy node
+		if (parentWidget
+			&& parentWidget->IsInitialized())
+		{
+			registry.GetHierarchy(textPtr).SetParent(parentWidget);
+			textPtr->transform->SetParent(parentWidget->GetTransform());
+		}
+
 		Log::Print(
 			"Loaded text '" + name + "' with ID '" + to_string(newID) + "'!",
 			"TEXT",
@@ -289,22 +285,7 @@ namespace KalaGraphics::UI
 			return false;
 		}
 		
-		//ensure AABB is up to date if pos, rot or size of the text changes
-		if (transform->GetPos(PosTarget::POS_COMBINED) != lastPos
-			|| transform->GetRot(RotTarget::ROT_COMBINED) != lastRot
-			|| transform->GetSize(SizeTarget::SIZE_COMBINED) != lastSize)
-		{
-			UpdateAABB();
-			
-			lastPos = transform->GetPos(PosTarget::POS_COMBINED);
-			lastRot = transform->GetRot(RotTarget::ROT_COMBINED);
-			lastSize = transform->GetSize(SizeTarget::SIZE_COMBINED);
-			
-			Log::Print(
-				"Updated AABB for text '" + name + "'.",
-				"TEXT",
-				LogType::LOG_DEBUG);
-		}
+		UpdateAABBIfMoved();
 
 		u32 programID = render.shader->GetProgramID();
 
@@ -317,57 +298,40 @@ namespace KalaGraphics::UI
 		render.shader->SetMat4(programID, "uModel", model);
 		render.shader->SetMat4(programID, "uProjection", projection);
 
-		bool isOpaque = render.opacity = 1.0f;
-		bool isTransparentTexture = 
-			render.texture
-			&& (render.texture->GetFormat() == TextureFormat::Format_RGBA8
-			|| render.texture->GetFormat() == TextureFormat::Format_RGBA16F
-			|| render.texture->GetFormat() == TextureFormat::Format_RGBA32F
-			|| render.texture->GetFormat() == TextureFormat::Format_SRGB8A8);
+		bool isAlpha = IsAlphaBlended();
 
-		bool isAlpha = 
-			isOpaque 
-			|| isTransparentTexture;
-
-		if (isAlpha)
-		{
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-			glDepthMask(GL_FALSE);
-		}
+		//state is not restored after the draw, the next widget only changes what differs
+		OpenGL_Core::SetBlendState(glID, isAlpha);
+		if (isAlpha) OpenGL_Core::BlendFunc(glID, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		OpenGL_Core::DepthMask(glID, !isAlpha);
 
 		render.shader->SetVec3(programID, "uColor", render.color);
 		render.shader->SetFloat(programID, "uOpacity", render.opacity);
 
 		if (render.texture)
 		{
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, render.texture->GetTextureID());
+			OpenGL_Core::ActiveTexture(glID, GL_TEXTURE0);
+			OpenGL_Core::BindTexture(glID, GL_TEXTURE_2D, render.texture->GetTextureID());
 			render.shader->SetInt(programID, "uTexture", 0);
 			render.shader->SetBool(programID, "uUseTexture", true);
 		}
 		else if (textureID != 0)
 		{
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, textureID);
+			OpenGL_Core::ActiveTexture(glID, GL_TEXTURE0);
+			OpenGL_Core::BindTexture(glID, GL_TEXTURE_2D, textureID);
 			render.shader->SetInt(programID, "uTexture", 0);
 			render.shader->SetBool(programID, "uUseTexture", true);
 		}
 		else render.shader->SetBool(programID, "uUseTexture", false);
 
-		glBindVertexArray(render.VAO);
+		const WidgetGeometry& geometry = GetGeometry(render.geometryID);
+
+		OpenGL_Core::BindVertexArray(glID, geometry.VAO);
 		glDrawElements(
 			GL_TRIANGLES,
-			render.indices.size(),
+			geometry.indices.size(),
 			GL_UNSIGNED_INT,
 			0);
-		glBindVertexArray(0);
-
-		if (isAlpha)
-		{
-			glDisable(GL_BLEND);
-			glDepthMask(GL_TRUE);
-		}
 
 		return true;
 	}
@@ -385,29 +349,10 @@ namespace KalaGraphics::UI
 			return;
 		}
 
+		//the shared glyph mesh is released by the widget destructor
 		Log::Print(
 			"Destroying widget '" + name + "' with ID '" + to_string(ID) + "'.",
 			"WIDGET",
 			LogType::LOG_INFO);
-
-		u32 vao = GetVAO();
-		u32 vbo = GetVBO();
-		u32 ebo = GetEBO();
-
-		if (vao != 0)
-		{
-			glDeleteVertexArrays(1, &vao);
-			vao = 0;
-		}
-		if (vbo != 0)
-		{
-			glDeleteBuffers(1, &vbo);
-			vbo = 0;
-		}
-		if (ebo != 0)
-		{
-			glDeleteBuffers(1, &ebo);
-			ebo = 0;
-		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,528 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <algorithm>
+#include <string>
+
+#include "KalaHeaders/log_utils.hpp"
+
+#include "ui/kg_tween.hpp"
+
+using KalaHeaders::Log;
+using KalaHeaders::LogType;
+using KalaHeaders::smoothstep;
+using KalaHeaders::wrap;
+using KalaHeaders::kclamp;
+
+using std::min;
+using std::max;
+using std::clamp;
+using std::to_string;
+
+namespace KalaGraphics::UI
+{
+	//Shortest accepted duration, anything below finishes on the next update
+	constexpr f32 MIN_TWEEN_DURATION = 1e-6f;
+
+	//Every curve except smoothstep is c * t^k before the split and 1 - c * (1 - t)^k after it,
+	//looked up per tween so mixed curves stay in one branch-free loop
+	constexpr u32 EASE_COUNT = 8;
+	constexpr u8 EASE_POWER[EASE_COUNT] = { 1, 1, 2, 2, 2, 3, 3, 3 };
+	constexpr f32 EASE_SCALE[EASE_COUNT] = { 1.0f, 1.0f, 1.0f, 1.0f, 2.0f, 1.0f, 1.0f, 4.0f };
+	constexpr f32 EASE_SPLIT[EASE_COUNT] = { 2.0f, 2.0f, 2.0f, -1.0f, 0.5f, 2.0f, -1.0f, 0.5f };
+
+	u32 TweenEngine::TweenPos(
+		Transform2D* target,
+		const vec2 from,
+		const vec2 to,
+		f32 duration,
+		TweenEase ease,
+		PosTarget posTarget)
+	{
+		if (posTarget == PosTarget::POS_COMBINED)
+		{
+			Log::Print(
+				"Cannot tween combined position!",
+				"TWEEN",
+				LogType::LOG_ERROR,
+				2);
+
+			return 0;
+		}
+
+		return AddTween(
+			target,
+			Transform2D::registry.GetHandle(target),
+			TweenTarget::TWEEN_POS,
+			static_cast<u8>(posTarget),
+			vec3(from, 0.0f),
+			vec3(to, 0.0f),
+			duration,
+			ease);
+	}
+	u32 TweenEngine::TweenRot(
+		Transform2D* target,
+		f32 from,
+		f32 to,
+		f32 duration,
+		TweenEase ease,
+		RotTarget rotTarget)
+	{
+		if (rotTarget == RotTarget::ROT_COMBINED)
+		{
+			Log::Print(
+				"Cannot tween combined rotation!",
+				"TWEEN",
+				LogType::LOG_ERROR,
+				2);
+
+			return 0;
+		}
+
+		return AddTween(
+			target,
+			Transform2D::registry.GetHandle(target),
+			TweenTarget::TWEEN_ROT,
+			static_cast<u8>(rotTarget),
+			vec3(from, 0.0f, 0.0f),
+			vec3(to, 0.0f, 0.0f),
+			duration,
+			ease);
+	}
+	u32 TweenEngine::TweenSize(
+		Transform2D* target,
+		const vec2 from,
+		const vec2 to,
+		f32 duration,
+		TweenEase ease,
+		SizeTarget sizeTarget)
+	{
+		if (sizeTarget == SizeTarget::SIZE_COMBINED)
+		{
+			Log::Print(
+				"Cannot tween combined size!",
+				"TWEEN",
+				LogType::LOG_ERROR,
+				2);
+
+			return 0;
+		}
+
+		return AddTween(
+			target,
+			Transform2D::registry.GetHandle(target),
+			TweenTarget::TWEEN_SIZE,
+			static_cast<u8>(sizeTarget),
+			vec3(from, 0.0f),
+			vec3(to, 0.0f),
+			duration,
+			ease);
+	}
+
+	u32 TweenEngine::TweenColor(
+		Widget* target,
+		const vec3& from,
+		const vec3& to,
+		f32 duration,
+		TweenEase ease)
+	{
+		return AddTween(
+			target,
+			Widget::registry.GetHandle(target),
+			TweenTarget::TWEEN_COLOR,
+			0,
+			from,
+			to,
+			duration,
+			ease);
+	}
+	u32 TweenEngine::TweenOpacity(
+		Widget* target,
+		f32 from,
+		f32 to,
+		f32 duration,
+		TweenEase ease)
+	{
+		return AddTween(
+			target,
+			Widget::registry.GetHandle(target),
+			TweenTarget::TWEEN_OPACITY,
+			0,
+			vec3(from, 0.0f, 0.0f),
+			vec3(to, 0.0f, 0.0f),
+			duration,
+			ease);
+	}
+
+	bool TweenEngine::Stop(u32 tweenID)
+	{
+		auto it = tweenIndices.find(tweenID);
+		if (it == tweenIndices.end()) return false;
+
+		RemoveAt(it->second);
+
+		return true;
+	}
+	void TweenEngine::StopAll()
+	{
+		elapsed.clear();
+		invDuration.clear();
+
+		fromX.clear();
+		fromY.clear();
+		fromZ.clear();
+		deltaX.clear();
+		deltaY.clear();
+		deltaZ.clear();
+
+		eases.clear();
+		progress.clear();
+
+		groupIndices.clear();
+		targetPtrs.clear();
+		targets.clear();
+		subTargets.clear();
+		IDs.clear();
+
+		groups.clear();
+		freeGroups.clear();
+		targetGroups.clear();
+		writtenGroups.clear();
+
+		tweenIndices.clear();
+		removedCount = 0;
+	}
+
+	void TweenEngine::Update(f32 deltaTime)
+	{
+		if (IDs.empty()) return;
+
+		f32 dt = max(deltaTime, 0.0f);
+		size_t count = IDs.size();
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			elapsed[i] += dt;
+
+			f32 t = min(elapsed[i] * invDuration[i], 1.0f);
+			f32 u = 1.0f - t;
+
+			u32 e = static_cast<u32>(eases[i]);
+			u8 k = EASE_POWER[e];
+
+			f32 tk = k == 1 ? t : (k == 2 ? t * t : t * t * t);
+			f32 uk = k == 1 ? u : (k == 2 ? u * u : u * u * u);
+
+			f32 eased = t < EASE_SPLIT[e]
+				? EASE_SCALE[e] * tk
+				: 1.0f - EASE_SCALE[e] * uk;
+
+			progress[i] = eases[i] == TweenEase::EASE_SMOOTHSTEP
+				? smoothstep(0.0f, 1.0f, t)
+				: eased;
+		}
+
+		//every target is checked once, all of its tweens share the result
+		for (TweenGroup& group : groups)
+		{
+			if (group.tweenCount == 0) continue;
+
+			group.isValid = group.isTransform
+				? Transform2D::registry.IsValid(group.handle)
+				: Widget::registry.IsValid(group.handle);
+		}
+
+		//written front to back so the newest tween of a shared value writes last,
+		//finished tweens are only marked here and compacted after the pass
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (IDs[i] == 0) continue;
+
+			u32 groupIndex = groupIndices[i];
+			TweenGroup& group = groups[groupIndex];
+
+			if (!group.isValid)
+			{
+				RemoveAt(static_cast<u32>(i));
+				continue;
+			}
+
+			f32 p = progress[i];
+			f32 x = fromX[i] + deltaX[i] * p;
+			f32 y = fromY[i] + deltaY[i] * p;
+
+			//endpoints were clamped when the tween started and eased progress stays in [0, 1],
+			//so values are written without the clamps of the setters
+			switch (targets[i])
+			{
+			case TweenTarget::TWEEN_POS:
+			{
+				Transform2D* t = static_cast<Transform2D*>(targetPtrs[i]);
+
+				if (static_cast<PosTarget>(subTargets[i]) == PosTarget::POS_WORLD) t->pos_world = vec2(x, y);
+				else t->pos_local = vec2(x, y);
+
+				break;
+			}
+			case TweenTarget::TWEEN_ROT:
+			{
+				Transform2D* t = static_cast<Transform2D*>(targetPtrs[i]);
+
+				if (static_cast<RotTarget>(subTargets[i]) == RotTarget::ROT_WORLD) t->rot_world = wrap(x);
+				else t->rot_local = wrap(x);
+
+				break;
+			}
+			case TweenTarget::TWEEN_SIZE:
+			{
+				Transform2D* t = static_cast<Transform2D*>(targetPtrs[i]);
+
+				if (static_cast<SizeTarget>(subTargets[i]) == SizeTarget::SIZE_WORLD) t->size_world = vec2(x, y);
+				else t->size_local = vec2(x, y);
+
+				break;
+			}
+			case TweenTarget::TWEEN_COLOR:
+			{
+				static_cast<Widget*>(targetPtrs[i])->render.color = vec3(x, y, fromZ[i] + deltaZ[i] * p);
+				break;
+			}
+			case TweenTarget::TWEEN_OPACITY:
+			{
+				static_cast<Widget*>(targetPtrs[i])->render.opacity = x;
+				break;
+			}
+			}
+
+			if (group.isTransform
+				&& !group.isWritten)
+			{
+				group.isWritten = true;
+				writtenGroups.push_back(groupIndex);
+			}
+
+			if (elapsed[i] * invDuration[i] >= 1.0f) RemoveAt(static_cast<u32>(i));
+		}
+
+		//released groups keep their target until reused, which cannot happen before this loop
+		for (u32 groupIndex : writtenGroups)
+		{
+			TweenGroup& group = groups[groupIndex];
+
+			static_cast<Transform2D*>(group.targetPtr)->MarkDirty();
+			group.isWritten = false;
+		}
+		writtenGroups.clear();
+
+		if (removedCount > 0) Compact();
+	}
+
+	u32 TweenEngine::AddTween(
+		void* targetPtr,
+		RegistryHandle handle,
+		TweenTarget target,
+		u8 subTarget,
+		const vec3& from,
+		const vec3& to,
+		f32 duration,
+		TweenEase ease)
+	{
+		if (!handle.IsValid())
+		{
+			Log::Print(
+				"Cannot tween a target that is not registered!",
+				"TWEEN",
+				LogType::LOG_ERROR,
+				2);
+
+			return 0;
+		}
+
+		if (static_cast<u32>(ease) >= EASE_COUNT)
+		{
+			Log::Print(
+				"Cannot tween with unknown easing curve '" + to_string(static_cast<u32>(ease)) + "'!",
+				"TWEEN",
+				LogType::LOG_ERROR,
+				2);
+
+			return 0;
+		}
+
+		vec3 clampedFrom = from;
+		vec3 clampedTo = to;
+
+		//rotations are wrapped per write instead so 0 to 720 still spins twice
+		switch (target)
+		{
+		case TweenTarget::TWEEN_POS:
+			clampedFrom = kclamp(from, vec3(MIN_POS), vec3(MAX_POS));
+			clampedTo = kclamp(to, vec3(MIN_POS), vec3(MAX_POS));
+			break;
+		case TweenTarget::TWEEN_SIZE:
+			clampedFrom = kclamp(from, vec3(MIN_SIZE), vec3(MAX_SIZE));
+			clampedTo = kclamp(to, vec3(MIN_SIZE), vec3(MAX_SIZE));
+			break;
+		case TweenTarget::TWEEN_COLOR:
+		case TweenTarget::TWEEN_OPACITY:
+			clampedFrom = kclamp(from, vec3(0.0f), vec3(1.0f));
+			clampedTo = kclamp(to, vec3(0.0f), vec3(1.0f));
+			break;
+		default:
+			break;
+		}
+
+		bool isTransform =
+			target == TweenTarget::TWEEN_POS
+			|| target == TweenTarget::TWEEN_ROT
+			|| target == TweenTarget::TWEEN_SIZE;
+
+		u32 newID = nextTweenID++;
+		tweenIndices[newID] = static_cast<u32>(IDs.size());
+
+		elapsed.push_back(0.0f);
+		invDuration.push_back(1.0f / max(duration, MIN_TWEEN_DURATION));
+
+		fromX.push_back(clampedFrom.x);
+		fromY.push_back(clampedFrom.y);
+		fromZ.push_back(clampedFrom.z);
+		deltaX.push_back(clampedTo.x - clampedFrom.x);
+		deltaY.push_back(clampedTo.y - clampedFrom.y);
+		deltaZ.push_back(clampedTo.z - clampedFrom.z);
+
+		eases.push_back(ease);
+		progress.push_back(0.0f);
+
+		groupIndices.push_back(AcquireGroup(targetPtr, handle, isTransform));
+		targetPtrs.push_back(targetPtr);
+		targets.push_back(target);
+		subTargets.push_back(subTarget);
+		IDs.push_back(newID);
+
+		return newID;
+	}
+
+	void TweenEngine::RemoveAt(u32 index)
+	{
+		tweenIndices.erase(IDs[index]);
+		IDs[index] = 0;
+
+		ReleaseGroup(groupIndices[index]);
+
+		++removedCount;
+	}
+
+	void TweenEngine::Compact()
+	{
+		size_t count = IDs.size();
+		u32 kept{};
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (IDs[i] == 0) continue;
+
+			if (kept != i)
+			{
+				elapsed[kept] = elapsed[i];
+				invDuration[kept] = invDuration[i];
+
+				fromX[kept] = fromX[i];
+				fromY[kept] = fromY[i];
+				fromZ[kept] = fromZ[i];
+				deltaX[kept] = deltaX[i];
+				deltaY[kept] = deltaY[i];
+				deltaZ[kept] = deltaZ[i];
+
+				eases[kept] = eases[i];
+				progress[kept] = progress[i];
+
+				groupIndices[kept] = groupIndices[i];
+				targetPtrs[kept] = targetPtrs[i];
+				targets[kept] = targets[i];
+				subTargets[kept] = subTargets[i];
+				IDs[kept] = IDs[i];
+
+				tweenIndices[IDs[kept]] = kept;
+			}
+
+			++kept;
+		}
+
+		elapsed.resize(kept);
+		invDuration.resize(kept);
+
+		fromX.resize(kept);
+		fromY.resize(kept);
+		fromZ.resize(kept);
+		deltaX.resize(kept);
+		deltaY.resize(kept);
+		deltaZ.resize(kept);
+
+		eases.resize(kept);
+		progress.resize(kept);
+
+		groupIndices.resize(kept);
+		targetPtrs.resize(kept);
+		targets.resize(kept);
+		subTargets.resize(kept);
+		IDs.resize(kept);
+
+		removedCount = 0;
+	}
+
+	u32 TweenEngine::AcquireGroup(
+		void* targetPtr,
+		RegistryHandle handle,
+		bool isTransform)
+	{
+		auto it = targetGroups.find(targetPtr);
+		if (it != targetGroups.end()
+			&& groups[it->second].handle == handle)
+		{
+			++groups[it->second].tweenCount;
+			return it->second;
+		}
+
+		u32 index{};
+		if (!freeGroups.empty())
+		{
+			index = freeGroups.back();
+			freeGroups.pop_back();
+		}
+		else
+		{
+			index = static_cast<u32>(groups.size());
+			groups.emplace_back();
+		}
+
+		TweenGroup& group = groups[index];
+		group.targetPtr = targetPtr;
+		group.handle = handle;
+		group.isTransform = isTransform;
+		group.isValid = true;
+		group.isWritten = false;
+		group.tweenCount = 1;
+
+		//a stale group of a destroyed target at this address is left to its remaining tweens
+		targetGroups[targetPtr] = index;
+
+		return index;
+	}
+
+	void TweenEngine::ReleaseGroup(u32 index)
+	{
+		TweenGroup& group = groups[index];
+		if (--group.tweenCount > 0) return;
+
+		auto it = targetGroups.find(group.targetPtr);
+		if (it != targetGroups.end()
+			&& it->second == index)
+		{
+			targetGroups.erase(it);
+		}
+
+		freeGroups.push_back(index);
+	}
+}
\ No newline at end of file
@@ -4,6 +4,7 @@
 //Read LICENSE.md for more information.
 
 #include <sstream>
+#include <immintrin.h>
 
 #include "KalaHeaders/log_utils.hpp"
 
@@ -11,22 +12,90 @@
 #include "ui/kg_widget.hpp"
 #include "ui/kg_text.hpp"
 #include "ui/kg_image.hpp"
+#include "ui/kg_render_queue.hpp"
 #include "graphics/opengl/kg_opengl_functions_core.hpp"
+#include "graphics/opengl/kg_opengl.hpp"
 
 using KalaHeaders::Log;
 using KalaHeaders::LogType;
 
 using KalaGraphics::Core::KalaGraphicsCore;
 using namespace KalaGraphics::Graphics::OpenGLFunctions;
+using KalaGraphics::Graphics::OpenGL::OpenGL_Core;
+using KalaGraphics::Graphics::TextureFormat;
 
 using std::to_string;
 using std::back_inserter;
 using std::min;
 using std::max;
 using std::ostringstream;
+using std::find;
+using std::sort;
+using std::clamp;
+using std::isnan;
 
 namespace KalaGraphics::UI
 {
+	static_assert(sizeof(WidgetOBB) == sizeof(f32) * 8, "Hit tests load each oriented box as two packed vectors!");
+
+	//Side of one hit grid cell in pixels
+	constexpr f32 HIT_GRID_CELL_SIZE = 64.0f;
+	//Widgets covering more cells than this are kept in one list that every query tests,
+	//so fullscreen panels do not fill hundreds of cells
+	constexpr u64 MAX_HIT_GRID_CELLS = 64;
+	//Cell coordinates are clamped to this range so huge positions never overflow i32,
+	//widgets past it share the border cells and are still tested against their exact bounds
+	constexpr f32 HIT_GRID_CELL_LIMIT = 1073741824.0f;
+
+	static inline u64 HitGridKey(
+		i32 x,
+		i32 y)
+	{
+		return (static_cast<u64>(static_cast<u32>(x)) << 32) | static_cast<u32>(y);
+	}
+	static inline i32 HitGridCell(f32 value)
+	{
+		f32 cell = floor(value / HIT_GRID_CELL_SIZE);
+
+		//NaN never passes a bounds test, widgets with NaN bounds are kept as oversized instead
+		if (isnan(cell)) return 0;
+
+		return static_cast<i32>(clamp(cell, -HIT_GRID_CELL_LIMIT, HIT_GRID_CELL_LIMIT));
+	}
+
+	//Higher Z order is on top, equal Z order is decided by the higher widget ID
+	//so every hit query agrees on the top widget whatever order the candidates came in
+	static inline bool IsHitAbove(
+		const Widget* a,
+		const Widget* b)
+	{
+		if (a->GetZOrder() != b->GetZOrder()) return a->GetZOrder() > b->GetZOrder();
+
+		return a->GetID() > b->GetID();
+	}
+
+	static inline bool IsPointInOBB(
+		const WidgetOBB& box,
+		vec2 point)
+	{
+		vec2 d = point - box.center;
+		f32 localX = d.x * box.axisX.x + d.y * box.axisX.y;
+		f32 localY = d.y * box.axisX.x - d.x * box.axisX.y;
+
+		return abs(localX) <= box.halfSize.x
+			&& abs(localY) <= box.halfSize.y;
+	}
+
+	static inline bool IsPointInAABB(
+		const array<vec2, 2>& aabb,
+		vec2 point)
+	{
+		return point.x >= aabb[0].x
+			&& point.x <= aabb[1].x
+			&& point.y >= aabb[0].y
+			&& point.y <= aabb[1].y;
+	}
+
 	vector<Widget*> Widget::GetHitWidgets(vec2 mousePos)
 	{
 		//
@@ -35,52 +104,261 @@ namespace KalaGraphics::UI
 
 		vector<Widget*> hitWidgets{};
 
-		for (const auto& w : registry.runtimeContent)
-		{
-			if (!w->isInteractable) continue;
-			
-			/*
-			ostringstream oss{};
-			
-			vec2 pos = w->transform->GetPos(PosTarget::POS_COMBINED);
-			f32 rot = w->transform->GetRot(RotTarget::ROT_COMBINED);
-			vec2 size = w->transform->GetSize(SizeTarget::SIZE_COMBINED);
-			
-			oss << w->name << "\n"
-				<< "  mouse:         " << mousePos.x << ", " << mousePos.y << "\n"
-				<< "  combined pos:  " << pos.x << ", " << pos.y << "\n"
-				<< "  combined rot:  " << rot << "\n"
-				<< "  combined size: " << size.x << ", " << size.y << "\n"
-				<< "  aabb:          " 
-					<< w->render.aabb[0].x << ", " 
-					<< w->render.aabb[0].y << ", " 
-					<< w->render.aabb[1].x << ", " 
-					<< w->render.aabb[1].y << "\n";
-				
-			Log::Print(
-				oss.str(),
-				"WIDGET",
-				LogType::LOG_INFO);
-			*/
+		//rotated widgets whose AABB contains the point, resolved together after the loop
+		static vector<Widget*> rotatedCandidates{};
+		static vector<WidgetOBB> rotatedBoxes{};
+		static vector<u64> rotatedHits{};
+
+		rotatedCandidates.clear();
+		rotatedBoxes.clear();
 
-			if (mousePos.x >= w->render.aabb[0].x
-				&& mousePos.x <= w->render.aabb[1].x
-				&& mousePos.y >= w->render.aabb[0].y
-				&& mousePos.y <= w->render.aabb[1].y)
+		auto testCandidates = [&](const vector<Widget*>& candidates)
 			{
-				hitWidgets.push_back(w);
+				for (Widget* w : candidates)
+				{
+					if (!w->isInteractable
+						|| !IsPointInAABB(w->render.aabb, mousePos))
+					{
+						continue;
+					}
+
+					if (!w->render.obb.isRotated) hitWidgets.push_back(w);
+					else
+					{
+						rotatedCandidates.push_back(w);
+						rotatedBoxes.push_back(w->render.obb);
+					}
+				}
+			};
+
+		auto it = hitGrid.find(HitGridKey(HitGridCell(mousePos.x), HitGridCell(mousePos.y)));
+		if (it != hitGrid.end()) testCandidates(it->second);
+		testCandidates(oversizedHitWidgets);
+
+		if (!rotatedCandidates.empty())
+		{
+			TestPointInOBBs(mousePos, rotatedBoxes, rotatedHits);
+
+			for (size_t i = 0; i < rotatedCandidates.size(); ++i)
+			{
+				if ((rotatedHits[i >> 6] >> (i & 63)) & 1) hitWidgets.push_back(rotatedCandidates[i]);
 			}
 		}
 
-		sort(hitWidgets.begin(), hitWidgets.end(),
-			[](Widget* a, Widget* b)
-			{
-				return a->zOrder < b->zOrder;
-			});
+		sort(hitWidgets.begin(), hitWidgets.end(), IsHitAbove);
 
 		return hitWidgets;
 	}
 
+	Widget* Widget::GetTopHitWidget(vec2 mousePos)
+	{
+		Widget* topWidget{};
+
+		auto testCandidates = [&](const vector<Widget*>& candidates)
+			{
+				for (Widget* w : candidates)
+				{
+					//same ordering as GetHitWidgets so this always matches its first widget
+					if (!w->isInteractable
+						|| (topWidget
+						&& !IsHitAbove(w, topWidget))
+						|| !IsPointInAABB(w->render.aabb, mousePos)
+						|| (w->render.obb.isRotated
+						&& !IsPointInOBB(w->render.obb, mousePos)))
+					{
+						continue;
+					}
+
+					topWidget = w;
+				}
+			};
+
+		auto it = hitGrid.find(HitGridKey(HitGridCell(mousePos.x), HitGridCell(mousePos.y)));
+		if (it != hitGrid.end()) testCandidates(it->second);
+		testCandidates(oversizedHitWidgets);
+
+		return topWidget;
+	}
+
+	void Widget::ResolveHover(vec2 mousePos)
+	{
+		if (isHoverResolved
+			&& hoverRevision == hitRevision
+			&& hoverMousePos == mousePos)
+		{
+			return;
+		}
+
+		hoverStack = GetHitWidgets(mousePos);
+		hoveredWidget = hoverStack.empty() ? nullptr : hoverStack[0];
+
+		hoverMousePos = mousePos;
+		hoverRevision = hitRevision;
+		isHoverResolved = true;
+	}
+
+	void Widget::UpdateHitGrid()
+	{
+		array<i32, 4> cells =
+		{
+			HitGridCell(render.aabb[0].x),
+			HitGridCell(render.aabb[0].y),
+			HitGridCell(render.aabb[1].x),
+			HitGridCell(render.aabb[1].y)
+		};
+
+		bool hasNaNBounds =
+			isnan(render.aabb[0].x)
+			|| isnan(render.aabb[0].y)
+			|| isnan(render.aabb[1].x)
+			|| isnan(render.aabb[1].y);
+
+		if (isInHitGrid
+			&& cells == hitGridCells
+			&& (!hasNaNBounds
+			|| isOversizedHit))
+		{
+			return;
+		}
+
+		RemoveFromHitGrid();
+
+		hitGridCells = cells;
+		isInHitGrid = true;
+
+		u64 cellCount =
+			static_cast<u64>(static_cast<i64>(cells[2]) - cells[0] + 1)
+			* static_cast<u64>(static_cast<i64>(cells[3]) - cells[1] + 1);
+
+		if (hasNaNBounds
+			|| cellCount > MAX_HIT_GRID_CELLS)
+		{
+			isOversizedHit = true;
+			oversizedHitWidgets.push_back(this);
+
+			return;
+		}
+
+		for (i32 y = cells[1]; y <= cells[3]; ++y)
+		{
+			for (i32 x = cells[0]; x <= cells[2]; ++x)
+			{
+				hitGrid[HitGridKey(x, y)].push_back(this);
+			}
+		}
+	}
+
+	void Widget::RemoveFromHitGrid()
+	{
+		if (!isInHitGrid) return;
+
+		auto eraseFrom = [this](vector<Widget*>& list)
+			{
+				auto found = find(list.begin(), list.end(), this);
+				if (found == list.end()) return;
+
+				*found = list.back();
+				list.pop_back();
+			};
+
+		if (isOversizedHit) eraseFrom(oversizedHitWidgets);
+		else
+		{
+			for (i32 y = hitGridCells[1]; y <= hitGridCells[3]; ++y)
+			{
+				for (i32 x = hitGridCells[0]; x <= hitGridCells[2]; ++x)
+				{
+					auto it = hitGrid.find(HitGridKey(x, y));
+					if (it == hitGrid.end()) continue;
+
+					eraseFrom(it->second);
+					if (it->second.empty()) hitGrid.erase(it);
+				}
+			}
+		}
+
+		isInHitGrid = false;
+		isOversizedHit = false;
+
+		++hitRevision;
+	}
+
+	void Widget::UpdateAABBIfMoved()
+	{
+		vec2 pos = transform->GetPos(PosTarget::POS_COMBINED);
+		f32 rot = transform->GetRot(RotTarget::ROT_COMBINED);
+		vec2 size = transform->GetSize(SizeTarget::SIZE_COMBINED);
+
+		if (pos == lastPos
+			&& rot == lastRot
+			&& size == lastSize)
+		{
+			return;
+		}
+
+		UpdateAABB();
+
+		lastPos = pos;
+		lastRot = rot;
+		lastSize = size;
+
+		Log::Print(
+			"Updated AABB for widget '" + name + "'.",
+			"WIDGET",
+			LogType::LOG_DEBUG);
+	}
+
+	void Widget::TestPointInOBBs(
+		vec2 point,
+		span<const WidgetOBB> boxes,
+		vector<u64>& outHits)
+	{
+		size_t count = boxes.size();
+		outHits.assign((count + 63) / 64, 0);
+
+		const f32* data = reinterpret_cast<const f32*>(boxes.data());
+
+		__m128 px = _mm_set1_ps(point.x);
+		__m128 py = _mm_set1_ps(point.y);
+		__m128 signMask = _mm_set1_ps(-0.0f);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			//each box is center.xy axisX.xy | halfSize.xy and padding
+			const f32* b = data + i * 8;
+			__m128 cx = _mm_loadu_ps(b);
+			__m128 cy = _mm_loadu_ps(b + 8);
+			__m128 ax = _mm_loadu_ps(b + 16);
+			__m128 ay = _mm_loadu_ps(b + 24);
+			_MM_TRANSPOSE4_PS(cx, cy, ax, ay);
+
+			__m128 hx = _mm_loadu_ps(b + 4);
+			__m128 hy = _mm_loadu_ps(b + 12);
+			__m128 h2 = _mm_loadu_ps(b + 20);
+			__m128 h3 = _mm_loadu_ps(b + 28);
+			_MM_TRANSPOSE4_PS(hx, hy, h2, h3);
+
+			__m128 dx = _mm_sub_ps(px, cx);
+			__m128 dy = _mm_sub_ps(py, cy);
+
+			//project onto axis X and axis Y, axis Y is (-ay, ax)
+			__m128 localX = _mm_add_ps(_mm_mul_ps(dx, ax), _mm_mul_ps(dy, ay));
+			__m128 localY = _mm_sub_ps(_mm_mul_ps(dy, ax), _mm_mul_ps(dx, ay));
+
+			__m128 isInside = _mm_and_ps(
+				_mm_cmple_ps(_mm_andnot_ps(signMask, localX), hx),
+				_mm_cmple_ps(_mm_andnot_ps(signMask, localY), hy));
+
+			//i is a multiple of four so the four bits never cross a word
+			outHits[i >> 6] |= static_cast<u64>(_mm_movemask_ps(isInside)) << (i & 63);
+		}
+		for (; i < count; ++i)
+		{
+			if (IsPointInOBB(boxes[i], point)) outHits[i >> 6] |= 1ull << (i & 63);
+		}
+	}
+
 	bool Widget::IsHovered(vec2 mousePos) const
 	{
 		if (!isInteractable)
@@ -93,11 +371,9 @@ namespace KalaGraphics::UI
 			return false;
 		}
 
-		const vector<Widget*>& hitWidgets = GetHitWidgets(mousePos);
+		ResolveHover(mousePos);
 
-		if (hitWidgets.empty()) return false;
-
-		return this == hitWidgets[0];
+		return this == hoveredWidget;
 	}
 
 	/*
@@ -152,7 +428,166 @@ namespace KalaGraphics::UI
 	}
 	*/
 
+	//FNV-1a over the raw mesh content, element counts are mixed in so differently split meshes never match
+	static u64 HashGeometry(
+		u32 targetGLID,
+		const vector<vec2>& vertices,
+		const vector<u32>& indices,
+		const vector<u32>& uvs)
+	{
+		u64 hash = 14695981039346656037ull;
+
+		auto mix = [&hash](
+			const void* data,
+			size_t size)
+			{
+				const u8* bytes = static_cast<const u8*>(data);
+				for (size_t i = 0; i < size; ++i)
+				{
+					hash ^= bytes[i];
+					hash *= 1099511628211ull;
+				}
+			};
+
+		u64 counts[3] = { vertices.size(), indices.size(), uvs.size() };
+
+		mix(&targetGLID, sizeof(targetGLID));
+		mix(counts, sizeof(counts));
+		mix(vertices.data(), vertices.size() * sizeof(vec2));
+		mix(indices.data(), indices.size() * sizeof(u32));
+		mix(uvs.data(), uvs.size() * sizeof(u32));
+
+		return hash;
+	}
+
+	u32 Widget::AcquireGeometry(
+		u32 targetGLID,
+		const vector<vec2>& vertices,
+		const vector<u32>& indices,
+		const vector<u32>& uvs)
+	{
+		u64 hash = HashGeometry(targetGLID, vertices, indices, uvs);
+
+		auto [first, last] = geometryLookup.equal_range(hash);
+		for (auto it = first; it != last; ++it)
+		{
+			WidgetGeometry& existing = geometries[it->second - 1];
+
+			if (existing.glID == targetGLID
+				&& existing.vertices == vertices
+				&& existing.indices == indices
+				&& existing.uvs == uvs)
+			{
+				++existing.refCount;
+				return it->second;
+			}
+		}
+
+		u32 geometryID{};
+		if (!freeGeometryIDs.empty())
+		{
+			geometryID = freeGeometryIDs.back();
+			freeGeometryIDs.pop_back();
+		}
+		else
+		{
+			geometries.emplace_back();
+			geometryID = static_cast<u32>(geometries.size());
+		}
+
+		WidgetGeometry& geometry = geometries[geometryID - 1];
+		geometry.glID = targetGLID;
+		geometry.refCount = 1;
+		geometry.contentHash = hash;
+		geometry.vertices = vertices;
+		geometry.indices = indices;
+		geometry.uvs = uvs;
+
+		CreateWidgetGeometry(
+			targetGLID,
+			vertices,
+			indices,
+			uvs,
+			geometry.VAO,
+			geometry.VBO,
+			geometry.EBO);
+
+		geometryLookup.emplace(hash, geometryID);
+
+		return geometryID;
+	}
+
+	void Widget::ReleaseGeometry(u32 geometryID)
+	{
+		if (geometryID == 0
+			|| geometryID > geometries.size())
+		{
+			return;
+		}
+
+		WidgetGeometry& geometry = geometries[geometryID - 1];
+
+		if (geometry.refCount == 0
+			|| --geometry.refCount > 0)
+		{
+			return;
+		}
+
+		OpenGL_Core::DeleteVertexArray(geometry.glID, geometry.VAO);
+		OpenGL_Core::DeleteBuffer(geometry.glID, geometry.VBO);
+		OpenGL_Core::DeleteBuffer(geometry.glID, geometry.EBO);
+
+		auto [first, last] = geometryLookup.equal_range(geometry.contentHash);
+		for (auto it = first; it != last; ++it)
+		{
+			if (it->second == geometryID)
+			{
+				geometryLookup.erase(it);
+				break;
+			}
+		}
+
+		geometry = WidgetGeometry{};
+		freeGeometryIDs.push_back(geometryID);
+	}
+
+	const WidgetGeometry& Widget::GetGeometry(u32 geometryID)
+	{
+		static const WidgetGeometry empty{};
+
+		return geometryID != 0
+			&& geometryID <= geometries.size()
+			? geometries[geometryID - 1]
+			: empty;
+	}
+
+	void Widget::SetGeometry(
+		vector<vec2> vertices,
+		vector<u32> indices,
+		vector<u32> uvs)
+	{
+		if (vertices.size() < 4
+			|| indices.empty()
+			|| uvs.size() < 8)
+		{
+			Log::Print(
+				"Cannot set geometry of widget '" + name + "' because it needs at least 4 vertices, 1 index and 8 uv values!",
+				"WIDGET",
+				LogType::LOG_ERROR,
+				2);
+
+			return;
+		}
+
+		//acquired first so a widget keeping its mesh never deletes and recreates it
+		u32 newGeometryID = AcquireGeometry(glID, vertices, indices, uvs);
+		ReleaseGeometry(render.geometryID);
+
+		render.geometryID = newGeometryID;
+	}
+
 	void Widget::CreateWidgetGeometry(
+		u32 targetGLID,
 		const vector<vec2>& vertices,
 		const vector<u32>& indices,
 		const vector<u32>& uvs,
@@ -199,10 +634,10 @@ namespace KalaGraphics::UI
 		glGenBuffers(1, &vboOut);
 		glGenBuffers(1, &eboOut);
 
-		glBindVertexArray(vaoOut);
+		OpenGL_Core::BindVertexArray(targetGLID, vaoOut);
 
 		//VBO
-		glBindBuffer(GL_ARRAY_BUFFER, vboOut);
+		OpenGL_Core::BindBuffer(targetGLID, GL_ARRAY_BUFFER, vboOut);
 		glBufferData(
 			GL_ARRAY_BUFFER,
 			verts.size() * sizeof(Vertex),
@@ -210,7 +645,7 @@ namespace KalaGraphics::UI
 			GL_STATIC_DRAW);
 
 		//EBO
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, eboOut);
+		OpenGL_Core::BindBuffer(targetGLID, GL_ELEMENT_ARRAY_BUFFER, eboOut);
 		glBufferData(
 			GL_ELEMENT_ARRAY_BUFFER,
 			indices.size() * sizeof(u32),
@@ -237,8 +672,41 @@ namespace KalaGraphics::UI
 			sizeof(Vertex),
 			(void*)offsetof(Vertex, uv));
 
-		glBindVertexArray(0);
+		OpenGL_Core::BindVertexArray(targetGLID, 0);
 	}
 
-	Widget::~Widget() {}
+	bool Widget::IsAlphaBlended() const
+	{
+		bool isTranslucent = render.opacity < 1.0f;
+		bool isTransparentTexture = 
+			render.texture
+			&& (render.texture->GetFormat() == TextureFormat::Format_RGBA8
+			|| render.texture->GetFormat() == TextureFormat::Format_RGBA16F
+			|| render.texture->GetFormat() == TextureFormat::Format_RGBA32F
+			|| render.texture->GetFormat() == TextureFormat::Format_SRGB8A8);
+
+		return isTranslucent
+			|| isTransparentTexture;
+	}
+
+	void Widget::Shutdown()
+	{
+		registry.RemoveAllContent();
+	}
+
+	Widget::~Widget()
+	{
+		if (isInRenderQueue) WidgetRenderQueue::Remove(this);
+		RemoveFromHitGrid();
+		ReleaseGeometry(render.geometryID);
+	}
+
+	//Every static inline member the widget destructors touch is defined before this object in this file,
+	//so it is initialized after them and destroyed before them. The constructor is not constexpr
+	//so the object is initialized dynamically and takes part in that order
+	static struct WidgetShutdownGuard
+	{
+		WidgetShutdownGuard() {}
+		~WidgetShutdownGuard() { Widget::Shutdown(); }
+	} widgetShutdownGuard{};
 }
\ No newline at end of file
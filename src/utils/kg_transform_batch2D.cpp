@@ -0,0 +1,543 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <algorithm>
+#include <chrono>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+#include "utils/kg_transform_batch2D.hpp"
+
+//MSVC emits any intrinsic without extra flags, GCC and Clang need the target per function
+#ifdef _MSC_VER
+#define KG_TARGET_AVX
+#else
+#define KG_TARGET_AVX __attribute__((target("avx")))
+#endif
+
+using KalaHeaders::createumodel;
+using KalaHeaders::vec2;
+
+using std::min;
+using std::chrono::steady_clock;
+using std::chrono::nanoseconds;
+using std::chrono::duration_cast;
+
+namespace KalaGraphics::Utils
+{
+	static_assert(sizeof(mat4) == sizeof(f32) * 16, "Batch kernels write mat4 as 16 packed floats!");
+
+	//Same value as KalaHeaders::radians
+	constexpr f32 DEG_TO_RAD = 0.017453f;
+
+	//Cody-Waite split of pi/2 so the range reduction stays accurate for a few turns
+	constexpr f32 PIO2_HI = 1.5703125f;
+	constexpr f32 PIO2_MID = 4.837512969970703125e-4f;
+	constexpr f32 PIO2_LO = 7.54978995489188216e-8f;
+	constexpr f32 TWO_O_PI = 0.636619772367581343f;
+
+	//Minimax polynomials for sin and cos on [-pi/4, pi/4]
+	constexpr f32 SIN_C1 = -1.6666654611e-1f;
+	constexpr f32 SIN_C2 = 8.3321608736e-3f;
+	constexpr f32 SIN_C3 = -1.9515295891e-4f;
+	constexpr f32 COS_C1 = 4.166664568298827e-2f;
+	constexpr f32 COS_C2 = -1.388731625493765e-3f;
+	constexpr f32 COS_C3 = 2.443315711809948e-5f;
+
+	static void BuildModelsScalar(
+		const f32* posX,
+		const f32* posY,
+		const f32* rot,
+		const f32* sizeX,
+		const f32* sizeY,
+		mat4* out,
+		size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			out[i] = createumodel(
+				vec2(posX[i], posY[i]),
+				rot[i],
+				vec2(sizeX[i], sizeY[i]));
+		}
+	}
+
+	//Writes four model matrices from the four lanes of each column value,
+	//a = cos * size.x, b = -sin * size.x, d = sin * size.y, e = cos * size.y
+	static inline void StoreModels4(
+		__m128 a,
+		__m128 b,
+		__m128 d,
+		__m128 e,
+		__m128 px,
+		__m128 py,
+		f32* out)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 col2 = _mm_setr_ps(0.0f, 0.0f, 1.0f, 0.0f);
+		const __m128 col3Tail = _mm_setr_ps(0.0f, 1.0f, 0.0f, 1.0f);
+
+		__m128 abLo = _mm_unpacklo_ps(a, b);
+		__m128 abHi = _mm_unpackhi_ps(a, b);
+		__m128 deLo = _mm_unpacklo_ps(d, e);
+		__m128 deHi = _mm_unpackhi_ps(d, e);
+		__m128 pLo = _mm_unpacklo_ps(px, py);
+		__m128 pHi = _mm_unpackhi_ps(px, py);
+
+		//movelh takes the low pair of each input, movehl the high pair
+		_mm_storeu_ps(out + 0, _mm_movelh_ps(abLo, zero));
+		_mm_storeu_ps(out + 4, _mm_movelh_ps(deLo, zero));
+		_mm_storeu_ps(out + 8, col2);
+		_mm_storeu_ps(out + 12, _mm_movelh_ps(pLo, col3Tail));
+
+		_mm_storeu_ps(out + 16, _mm_movehl_ps(zero, abLo));
+		_mm_storeu_ps(out + 20, _mm_movehl_ps(zero, deLo));
+		_mm_storeu_ps(out + 24, col2);
+		_mm_storeu_ps(out + 28, _mm_movehl_ps(col3Tail, pLo));
+
+		_mm_storeu_ps(out + 32, _mm_movelh_ps(abHi, zero));
+		_mm_storeu_ps(out + 36, _mm_movelh_ps(deHi, zero));
+		_mm_storeu_ps(out + 40, col2);
+		_mm_storeu_ps(out + 44, _mm_movelh_ps(pHi, col3Tail));
+
+		_mm_storeu_ps(out + 48, _mm_movehl_ps(zero, abHi));
+		_mm_storeu_ps(out + 52, _mm_movehl_ps(zero, deHi));
+		_mm_storeu_ps(out + 56, col2);
+		_mm_storeu_ps(out + 60, _mm_movehl_ps(col3Tail, pHi));
+	}
+
+	//Sine and cosine of four angles in degrees
+	static inline void SinCos4(
+		__m128 deg,
+		__m128& sinOut,
+		__m128& cosOut)
+	{
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+
+		__m128 x = _mm_mul_ps(deg, _mm_set1_ps(DEG_TO_RAD));
+
+		//quadrant and remainder in [-pi/4, pi/4]
+		__m128i q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(TWO_O_PI)));
+		__m128 qf = _mm_cvtepi32_ps(q);
+		x = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(PIO2_HI)));
+		x = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(PIO2_MID)));
+		x = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(PIO2_LO)));
+
+		__m128 x2 = _mm_mul_ps(x, x);
+
+		__m128 s = _mm_add_ps(_mm_mul_ps(x2, _mm_set1_ps(SIN_C3)), _mm_set1_ps(SIN_C2));
+		s = _mm_add_ps(_mm_mul_ps(s, x2), _mm_set1_ps(SIN_C1));
+		s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, x2), x), x);
+
+		__m128 c = _mm_add_ps(_mm_mul_ps(x2, _mm_set1_ps(COS_C3)), _mm_set1_ps(COS_C2));
+		c = _mm_add_ps(_mm_mul_ps(c, x2), _mm_set1_ps(COS_C1));
+		c = _mm_mul_ps(_mm_mul_ps(c, x2), x2);
+		c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(x2, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+		//odd quadrants swap sin and cos, quadrants 2-3 flip sin and 1-2 flip cos
+		__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(
+			_mm_and_si128(q, _mm_set1_epi32(1)),
+			_mm_set1_epi32(1)));
+		__m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30));
+		__m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(
+			_mm_and_si128(_mm_add_epi32(q, _mm_set1_epi32(1)), _mm_set1_epi32(2)),
+			30));
+
+		__m128 sinRaw = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+		__m128 cosRaw = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+
+		sinOut = _mm_xor_ps(sinRaw, _mm_and_ps(sinSign, signMask));
+		cosOut = _mm_xor_ps(cosRaw, _mm_and_ps(cosSign, signMask));
+	}
+
+	static void BuildModelsSSE2(
+		const f32* posX,
+		const f32* posY,
+		const f32* rot,
+		const f32* sizeX,
+		const f32* sizeY,
+		mat4* out,
+		size_t count)
+	{
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 s{};
+			__m128 c{};
+			SinCos4(_mm_loadu_ps(rot + i), s, c);
+
+			__m128 sx = _mm_loadu_ps(sizeX + i);
+			__m128 sy = _mm_loadu_ps(sizeY + i);
+
+			StoreModels4(
+				_mm_mul_ps(c, sx),
+				_mm_xor_ps(_mm_mul_ps(s, sx), _mm_set1_ps(-0.0f)),
+				_mm_mul_ps(s, sy),
+				_mm_mul_ps(c, sy),
+				_mm_loadu_ps(posX + i),
+				_mm_loadu_ps(posY + i),
+				reinterpret_cast<f32*>(out + i));
+		}
+
+		BuildModelsScalar(
+			posX + i,
+			posY + i,
+			rot + i,
+			sizeX + i,
+			sizeY + i,
+			out + i,
+			count - i);
+	}
+
+	//Same math as SinCos4 over eight lanes, AVX1 has no 256-bit integer ops
+	//so the quadrant bits go through float compares instead
+	KG_TARGET_AVX static inline void SinCos8(
+		__m256 deg,
+		__m256& sinOut,
+		__m256& cosOut)
+	{
+		const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+		__m256 x = _mm256_mul_ps(deg, _mm256_set1_ps(DEG_TO_RAD));
+
+		__m256 qf = _mm256_round_ps(
+			_mm256_mul_ps(x, _mm256_set1_ps(TWO_O_PI)),
+			_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		x = _mm256_sub_ps(x, _mm256_mul_ps(qf, _mm256_set1_ps(PIO2_HI)));
+		x = _mm256_sub_ps(x, _mm256_mul_ps(qf, _mm256_set1_ps(PIO2_MID)));
+		x = _mm256_sub_ps(x, _mm256_mul_ps(qf, _mm256_set1_ps(PIO2_LO)));
+
+		__m256 x2 = _mm256_mul_ps(x, x);
+
+		__m256 s = _mm256_add_ps(_mm256_mul_ps(x2, _mm256_set1_ps(SIN_C3)), _mm256_set1_ps(SIN_C2));
+		s = _mm256_add_ps(_mm256_mul_ps(s, x2), _mm256_set1_ps(SIN_C1));
+		s = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(s, x2), x), x);
+
+		__m256 c = _mm256_add_ps(_mm256_mul_ps(x2, _mm256_set1_ps(COS_C3)), _mm256_set1_ps(COS_C2));
+		c = _mm256_add_ps(_mm256_mul_ps(c, x2), _mm256_set1_ps(COS_C1));
+		c = _mm256_mul_ps(_mm256_mul_ps(c, x2), x2);
+		c = _mm256_add_ps(_mm256_sub_ps(c, _mm256_mul_ps(x2, _mm256_set1_ps(0.5f))), _mm256_set1_ps(1.0f));
+
+		//q mod 4 as a float in [0, 4)
+		__m256 qMod4 = _mm256_sub_ps(
+			qf,
+			_mm256_mul_ps(
+				_mm256_floor_ps(_mm256_mul_ps(qf, _mm256_set1_ps(0.25f))),
+				_mm256_set1_ps(4.0f)));
+
+		__m256 swap = _mm256_or_ps(
+			_mm256_cmp_ps(qMod4, _mm256_set1_ps(1.0f), _CMP_EQ_OQ),
+			_mm256_cmp_ps(qMod4, _mm256_set1_ps(3.0f), _CMP_EQ_OQ));
+		__m256 sinFlip = _mm256_cmp_ps(qMod4, _mm256_set1_ps(2.0f), _CMP_GE_OQ);
+		__m256 cosFlip = _mm256_and_ps(
+			_mm256_cmp_ps(qMod4, _mm256_set1_ps(1.0f), _CMP_GE_OQ),
+			_mm256_cmp_ps(qMod4, _mm256_set1_ps(2.0f), _CMP_LE_OQ));
+
+		__m256 sinRaw = _mm256_blendv_ps(s, c, swap);
+		__m256 cosRaw = _mm256_blendv_ps(c, s, swap);
+
+		sinOut = _mm256_xor_ps(sinRaw, _mm256_and_ps(sinFlip, signMask));
+		cosOut = _mm256_xor_ps(cosRaw, _mm256_and_ps(cosFlip, signMask));
+	}
+
+	//Writes eight model matrices as two 32-byte halves each, same lane values as StoreModels4.
+	//In-lane unpacks pair up matrices 0-1, 2-3, 4-5 and 6-7, the cross-lane permute then
+	//moves the second column (or the translation) next to the first one
+	KG_TARGET_AVX static inline void StoreModels8(
+		__m256 a,
+		__m256 b,
+		__m256 d,
+		__m256 e,
+		__m256 px,
+		__m256 py,
+		f32* out)
+	{
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 tail = _mm256_setr_ps(0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+
+		__m256 ab[2] = { _mm256_unpacklo_ps(a, b), _mm256_unpackhi_ps(a, b) };
+		__m256 de[2] = { _mm256_unpacklo_ps(d, e), _mm256_unpackhi_ps(d, e) };
+		__m256 p[2] = { _mm256_unpacklo_ps(px, py), _mm256_unpackhi_ps(px, py) };
+
+		//ab[0] holds matrices 0, 1 | 4, 5 and ab[1] holds 2, 3 | 6, 7
+		for (u32 half = 0; half < 2; ++half)
+		{
+			//second matrix of each pair moved to the front of its lane
+			__m256 abNext = _mm256_permute_ps(ab[half], _MM_SHUFFLE(1, 0, 3, 2));
+			__m256 deNext = _mm256_permute_ps(de[half], _MM_SHUFFLE(1, 0, 3, 2));
+			__m256 pNext = _mm256_permute_ps(p[half], _MM_SHUFFLE(1, 0, 3, 2));
+
+			const __m256 abSrc[2] = { ab[half], abNext };
+			const __m256 deSrc[2] = { de[half], deNext };
+			const __m256 pSrc[2] = { p[half], pNext };
+
+			for (u32 pair = 0; pair < 2; ++pair)
+			{
+				f32* low = out + (half * 2 + pair) * 16;
+				f32* high = low + 64;
+
+				//0x20 joins both low lanes, 0x31 both high lanes and 0x30 the low lane of tail with the high lane of p
+				_mm256_storeu_ps(low, _mm256_blend_ps(_mm256_permute2f128_ps(abSrc[pair], deSrc[pair], 0x20), zero, 0xCC));
+				_mm256_storeu_ps(low + 8, _mm256_blend_ps(_mm256_permute2f128_ps(tail, pSrc[pair], 0x20), tail, 0xC0));
+				_mm256_storeu_ps(high, _mm256_blend_ps(_mm256_permute2f128_ps(abSrc[pair], deSrc[pair], 0x31), zero, 0xCC));
+				_mm256_storeu_ps(high + 8, _mm256_blend_ps(_mm256_permute2f128_ps(tail, pSrc[pair], 0x30), tail, 0xC0));
+			}
+		}
+	}
+
+	KG_TARGET_AVX static void BuildModelsAVX(
+		const f32* posX,
+		const f32* posY,
+		const f32* rot,
+		const f32* sizeX,
+		const f32* sizeY,
+		mat4* out,
+		size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 s{};
+			__m256 c{};
+			SinCos8(_mm256_loadu_ps(rot + i), s, c);
+
+			__m256 sx = _mm256_loadu_ps(sizeX + i);
+			__m256 sy = _mm256_loadu_ps(sizeY + i);
+
+			__m256 a = _mm256_mul_ps(c, sx);
+			__m256 b = _mm256_xor_ps(_mm256_mul_ps(s, sx), _mm256_set1_ps(-0.0f));
+			__m256 d = _mm256_mul_ps(s, sy);
+			__m256 e = _mm256_mul_ps(c, sy);
+
+			StoreModels8(
+				a,
+				b,
+				d,
+				e,
+				_mm256_loadu_ps(posX + i),
+				_mm256_loadu_ps(posY + i),
+				reinterpret_cast<f32*>(out + i));
+		}
+
+		BuildModelsSSE2(
+			posX + i,
+			posY + i,
+			rot + i,
+			sizeX + i,
+			sizeY + i,
+			out + i,
+			count - i);
+	}
+
+	SimdLevel TransformBatch2D::GetSupportedSimdLevel()
+	{
+		static const SimdLevel supported = []()
+			{
+				u32 regs[4]{};
+#ifdef _MSC_VER
+				__cpuid(reinterpret_cast<int*>(regs), 1);
+#else
+				__cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+#endif
+				//x64 always has SSE2
+				bool hasAVX = (regs[2] & (1u << 28)) != 0;
+				bool hasOSXSAVE = (regs[2] & (1u << 27)) != 0;
+
+				if (!hasAVX
+					|| !hasOSXSAVE)
+				{
+					return SimdLevel::SIMD_SSE2;
+				}
+
+				//the OS must save the upper ymm halves on context switches
+				u32 xcr0Lo{};
+#ifdef _MSC_VER
+				xcr0Lo = static_cast<u32>(_xgetbv(0));
+#else
+				u32 xcr0Hi{};
+				__asm__("xgetbv" : "=a"(xcr0Lo), "=d"(xcr0Hi) : "c"(0));
+#endif
+				return (xcr0Lo & 0x6) == 0x6
+					? SimdLevel::SIMD_AVX
+					: SimdLevel::SIMD_SSE2;
+			}();
+
+		return supported;
+	}
+
+	SimdLevel TransformBatch2D::PickFastestSimdLevel()
+	{
+		constexpr size_t sampleCount = 256;
+		constexpr u32 sampleRounds = 8;
+
+		vector<f32> samples(sampleCount);
+		vector<mat4> sampleModels(sampleCount);
+		for (size_t i = 0; i < sampleCount; ++i) samples[i] = static_cast<f32>(i) * 7.3f;
+
+		const f32* in = samples.data();
+
+		SimdLevel fastest = SimdLevel::SIMD_SCALAR;
+		nanoseconds fastestTime = nanoseconds::max();
+
+		for (int level = 0; level <= static_cast<int>(GetSupportedSimdLevel()); ++level)
+		{
+			//best of a few rounds so a single interrupt does not decide the kernel
+			nanoseconds levelTime = nanoseconds::max();
+			for (u32 round = 0; round < sampleRounds; ++round)
+			{
+				auto start = steady_clock::now();
+
+				switch (static_cast<SimdLevel>(level))
+				{
+				case SimdLevel::SIMD_AVX:
+					BuildModelsAVX(in, in, in, in, in, sampleModels.data(), sampleCount);
+					break;
+				case SimdLevel::SIMD_SSE2:
+					BuildModelsSSE2(in, in, in, in, in, sampleModels.data(), sampleCount);
+					break;
+				default:
+					BuildModelsScalar(in, in, in, in, in, sampleModels.data(), sampleCount);
+					break;
+				}
+
+				levelTime = min(levelTime, duration_cast<nanoseconds>(steady_clock::now() - start));
+			}
+
+			if (levelTime < fastestTime)
+			{
+				fastestTime = levelTime;
+				fastest = static_cast<SimdLevel>(level);
+			}
+		}
+
+		return fastest;
+	}
+
+	void TransformBatch2D::SetSimdLevel(SimdLevel newLevel)
+	{
+		simdLevel = static_cast<SimdLevel>(min(
+			static_cast<int>(newLevel),
+			static_cast<int>(GetSupportedSimdLevel())));
+		isSimdLevelPicked = true;
+	}
+
+	span<const mat4> TransformBatch2D::Solve()
+	{
+		if (!NeedsSolve()) return models;
+
+		Transform2D::UpdateDirtyTransforms();
+
+		span<const KalaGraphicsTraversalEntry<Transform2D>> order = Transform2D::registry.GetTraversalOrder();
+		u32 count = static_cast<u32>(order.size());
+
+		if (solvedTraversalRevision != Transform2D::registry.traversalRevision
+			|| Transform2D::isUpdatedRangeOverflow
+			|| models.size() != count)
+		{
+			batchPosX.resize(count);
+			batchPosY.resize(count);
+			batchRot.resize(count);
+			batchSizeX.resize(count);
+			batchSizeY.resize(count);
+			models.resize(count);
+
+			SolveRange(order, 0, count);
+		}
+		else
+		{
+			for (const Transform2D::UpdatedRange& range : Transform2D::updatedRanges)
+			{
+				SolveRange(order, range.start, range.end);
+			}
+		}
+
+		Transform2D::updatedRanges.clear();
+		Transform2D::isUpdatedRangeOverflow = false;
+		solvedTraversalRevision = Transform2D::registry.traversalRevision;
+
+		return models;
+	}
+
+	mat4 TransformBatch2D::GetModel(Transform2D* transform)
+	{
+		if (!transform) return mat4{};
+
+		//widgets ask for their model one by one, so the common nothing-changed case stays a few compares
+		if (NeedsSolve()) Solve();
+
+		u32 index = Transform2D::registry.GetHierarchy(transform).traversalIndex;
+		if (index < models.size()) return models[index];
+
+		return createumodel(
+			transform->GetPos(PosTarget::POS_COMBINED),
+			transform->GetRot(RotTarget::ROT_COMBINED),
+			transform->GetSize(SizeTarget::SIZE_COMBINED));
+	}
+
+	bool TransformBatch2D::NeedsSolve()
+	{
+		return !Transform2D::dirtyTransforms.empty()
+			|| Transform2D::registry.HasQueuedContent()
+			|| !Transform2D::updatedRanges.empty()
+			|| Transform2D::isUpdatedRangeOverflow
+			|| Transform2D::registry.isTraversalDirty
+			|| solvedTraversalRevision != Transform2D::registry.traversalRevision;
+	}
+
+	void TransformBatch2D::SolveRange(
+		span<const KalaGraphicsTraversalEntry<Transform2D>> order,
+		u32 start,
+		u32 end)
+	{
+		for (u32 i = start; i < end; ++i)
+		{
+			const Transform2D* t = order[i].object;
+
+			batchPosX[i] = t->pos_combined.x;
+			batchPosY[i] = t->pos_combined.y;
+			batchRot[i] = t->rot_combined;
+			batchSizeX[i] = t->size_combined.x;
+			batchSizeY[i] = t->size_combined.y;
+		}
+
+		BuildModels(
+			batchPosX.data() + start,
+			batchPosY.data() + start,
+			batchRot.data() + start,
+			batchSizeX.data() + start,
+			batchSizeY.data() + start,
+			models.data() + start,
+			end - start);
+	}
+
+	void TransformBatch2D::BuildModels(
+		const f32* posX,
+		const f32* posY,
+		const f32* rot,
+		const f32* sizeX,
+		const f32* sizeY,
+		mat4* out,
+		size_t count)
+	{
+		if (!isSimdLevelPicked) SetSimdLevel(PickFastestSimdLevel());
+
+		switch (simdLevel)
+		{
+		case SimdLevel::SIMD_AVX:
+			BuildModelsAVX(posX, posY, rot, sizeX, sizeY, out, count);
+			break;
+		case SimdLevel::SIMD_SSE2:
+			BuildModelsSSE2(posX, posY, rot, sizeX, sizeY, out, count);
+			break;
+		default:
+			BuildModelsScalar(posX, posY, rot, sizeX, sizeY, out, count);
+			break;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,224 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <algorithm>
+
+#include "KalaHeaders/log_utils.hpp"
+#include "KalaHeaders/thread_utils.hpp"
+
+#include "core/kg_core.hpp"
+#include "utils/kg_transform_batch3D.hpp"
+
+using KalaHeaders::Log;
+using KalaHeaders::LogType;
+using KalaHeaders::jthread;
+
+using KalaGraphics::Core::KalaGraphicsCore;
+
+using std::unique_lock;
+using std::lock_guard;
+using std::memory_order_relaxed;
+using std::max;
+using std::min;
+
+namespace KalaGraphics::Utils
+{
+	//Scenes below this size are solved on the calling thread, starting workers costs more than the work
+	constexpr u32 MIN_PARALLEL_TRANSFORMS = 4096;
+	//Smallest subtree handed to a worker as its own task
+	constexpr u32 MIN_TASK_TRANSFORMS = 256;
+	//Tasks per worker, more tasks even out uneven subtrees
+	constexpr u32 TASKS_PER_WORKER = 4;
+
+	span<const WorldMatrix3D> TransformBatch3D::Solve(u32 threadCount)
+	{
+		if (Transform3D::registry.HasQueuedContent()) Transform3D::registry.FlushQueuedContent();
+
+		span<const KalaGraphicsTraversalEntry<Transform3D>> order = Transform3D::registry.GetTraversalOrder();
+		u32 count = static_cast<u32>(order.size());
+
+		worlds.resize(count);
+		solvedTraversalRevision = Transform3D::registry.traversalRevision;
+
+		if (threadCount == 0) threadCount = max(thread::hardware_concurrency(), 1u);
+
+		if (threadCount == 1
+			|| count < MIN_PARALLEL_TRANSFORMS)
+		{
+			for (u32 i = 0; i < count; ++i) SolveNode(order, i);
+
+			return worlds;
+		}
+
+		//split into whole subtrees no larger than the grain, ancestors of larger subtrees go to the spine
+		u32 grain = max(count / (threadCount * TASKS_PER_WORKER), MIN_TASK_TRANSFORMS);
+
+		spine.clear();
+		tasks.clear();
+
+		u32 i = 0;
+		while (i < count)
+		{
+			u32 subtreeSize = order[i].subtreeSize;
+
+			if (subtreeSize > grain)
+			{
+				spine.push_back(i);
+				++i;
+
+				continue;
+			}
+
+			//neighbouring small subtrees are merged so tasks stay close to the grain
+			if (!tasks.empty()
+				&& tasks.back().end == i
+				&& tasks.back().end - tasks.back().start + subtreeSize <= grain)
+			{
+				tasks.back().end += subtreeSize;
+			}
+			else tasks.push_back({ i, i + subtreeSize });
+
+			i += subtreeSize;
+		}
+
+		//spine entries are in pre-order, so every spine parent is solved before its spine children
+		for (u32 s : spine) SolveNode(order, s);
+
+		//the calling thread is one of the workers
+		u32 helperCount = min(threadCount, static_cast<u32>(tasks.size())) - 1;
+
+		solveOrder = order;
+		nextTask.store(0, memory_order_relaxed);
+
+		{
+			lock_guard<mutex> lock(poolMutex);
+
+			while (workers.size() < helperCount)
+			{
+				u32 workerIndex = static_cast<u32>(workers.size());
+				workers.push_back(jthread([workerIndex]() { WorkerLoop(workerIndex); }));
+			}
+
+			//tasks, spine results and the counter above are published to the workers by this lock
+			activeWorkerCount = helperCount;
+			busyWorkerCount = helperCount;
+			++solveGeneration;
+		}
+		poolWake.notify_all();
+
+		RunTasks();
+
+		unique_lock<mutex> lock(poolMutex);
+		poolDone.wait(lock, []() { return busyWorkerCount == 0; });
+
+		return worlds;
+	}
+
+	void TransformBatch3D::Shutdown()
+	{
+		{
+			lock_guard<mutex> lock(poolMutex);
+			isPoolStopping = true;
+		}
+		poolWake.notify_all();
+
+		for (thread& w : workers) w.join();
+
+		workers.clear();
+		isPoolStopping = false;
+	}
+
+	void TransformBatch3D::WorkerLoop(u32 workerIndex)
+	{
+		u64 seenGeneration{};
+
+		unique_lock<mutex> lock(poolMutex);
+		while (true)
+		{
+			poolWake.wait(lock, [&seenGeneration]()
+				{
+					return isPoolStopping
+						|| solveGeneration != seenGeneration;
+				});
+
+			if (isPoolStopping) return;
+
+			seenGeneration = solveGeneration;
+
+			//the pool is larger than this solve needs
+			if (workerIndex >= activeWorkerCount) continue;
+
+			lock.unlock();
+			RunTasks();
+			lock.lock();
+
+			if (--busyWorkerCount == 0) poolDone.notify_one();
+		}
+	}
+
+	void TransformBatch3D::RunTasks()
+	{
+		for (u32 t = nextTask.fetch_add(1, memory_order_relaxed);
+			t < tasks.size();
+			t = nextTask.fetch_add(1, memory_order_relaxed))
+		{
+			for (u32 n = tasks[t].start; n < tasks[t].end; ++n) SolveNode(solveOrder, n);
+		}
+	}
+
+	const mat4& TransformBatch3D::GetWorld(Transform3D* transform)
+	{
+		static const mat4 identity{};
+
+		if (!transform) return identity;
+
+		if (Transform3D::registry.isTraversalDirty
+			|| solvedTraversalRevision != Transform3D::registry.traversalRevision)
+		{
+			if (!KalaGraphicsCore::IsMainThread())
+			{
+				Log::Print(
+					"Cannot get world matrix of a transform added or relinked since the last solve outside the main thread!",
+					"TRANSFORM_3D",
+					LogType::LOG_ERROR,
+					2);
+
+				return identity;
+			}
+
+			Solve();
+		}
+
+		u32 index = Transform3D::registry.GetHierarchy(transform).traversalIndex;
+
+		return index < worlds.size()
+			? worlds[index].world
+			: identity;
+	}
+
+	void TransformBatch3D::SolveNode(
+		span<const KalaGraphicsTraversalEntry<Transform3D>> order,
+		u32 index)
+	{
+		const KalaGraphicsTraversalEntry<Transform3D>& entry = order[index];
+		Transform3D* t = entry.object;
+
+		//roots only use their world values, same as a standalone Transform3D
+		t->UpdateTransform(entry.parentIndex != REGISTRY_INVALID_INDEX
+			? order[entry.parentIndex].object
+			: nullptr);
+
+		//cached per transform, static transforms skip the rebuild
+		worlds[index].world = t->GetWorldMatrix();
+	}
+
+	//Defined after the pool members, so the workers are joined before any of them is destroyed.
+	//The constructor is not constexpr so the object is initialized dynamically and takes part in that order
+	static struct TransformBatch3DShutdownGuard
+	{
+		TransformBatch3DShutdownGuard() {}
+		~TransformBatch3DShutdownGuard() { TransformBatch3D::Shutdown(); }
+	} transformBatch3DShutdownGuard{};
+}
\ No newline at end of file